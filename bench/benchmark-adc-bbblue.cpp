@@ -0,0 +1,404 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "adc-channel.hpp"
+#include "adc-sampler.hpp"
+#include "cluon-complete.hpp"
+#include "opendlv-standard-message-set.hpp"
+#include "raw-archive.hpp"
+#include "shared-voltage-reader.hpp"
+#include "shared-voltage-ring.hpp"
+#include "voltage-envelope-encoder.hpp"
+
+// Counts heap allocations to report allocations per operation.
+static std::atomic<uint64_t> g_allocations{0};
+
+void *operator new(size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  void *p{::malloc((size > 0) ? size : 1)};
+  if (nullptr == p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+__attribute__((noinline)) void operator delete(void *p) noexcept {
+  ::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept {
+  ::free(p);
+}
+
+// Runs the given operation a number of times, timing each run, and reports
+// the mean and percentiles in nanoseconds and the allocations per operation.
+// Each timing includes one clock read, see the "timer overhead" line.
+static void benchmark(std::string const &name, uint32_t iterations,
+                      std::function<void()> operation) {
+  iterations = std::max<uint32_t>(iterations, 1);
+  for (uint32_t i{0}; i < iterations / 10; i++) {
+    operation();
+  }
+  std::vector<int64_t> durations(iterations);
+  uint64_t const ALLOCATIONS{g_allocations.load()};
+  for (uint32_t i{0}; i < iterations; i++) {
+    auto const START{std::chrono::steady_clock::now()};
+    operation();
+    auto const END{std::chrono::steady_clock::now()};
+    durations[i] =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(END - START)
+            .count();
+  }
+  double const ALLOCATIONS_PER_OP{
+      static_cast<double>(g_allocations.load() - ALLOCATIONS) / iterations};
+
+  int64_t total{0};
+  for (int64_t duration : durations) {
+    total += duration;
+  }
+  std::sort(durations.begin(), durations.end());
+  auto percentile{[&durations](double fraction) {
+    return durations[static_cast<size_t>(fraction * (durations.size() - 1))];
+  }};
+  std::cout << std::left << std::setw(46) << name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(10)
+            << static_cast<double>(total) / iterations << " ns/op"
+            << "  p50 " << std::setw(7) << percentile(0.5) << "  p99 "
+            << std::setw(7) << percentile(0.99) << "  p999 " << std::setw(7)
+            << percentile(0.999) << std::setprecision(2) << std::setw(8)
+            << ALLOCATIONS_PER_OP << " allocations/op" << std::endl;
+}
+
+// The encoding done by OD4Session::send followed by serializeEnvelope.
+static std::string encodeWithCluon(float voltage,
+                                   cluon::data::TimeStamp const &sent,
+                                   cluon::data::TimeStamp const &sampleTime,
+                                   uint32_t senderStamp) {
+  opendlv::proxy::VoltageReading voltageReading;
+  voltageReading.voltage(voltage);
+  cluon::ToProtoVisitor protoEncoder;
+  cluon::data::Envelope envelope;
+  envelope.dataType(static_cast<int32_t>(voltageReading.ID()));
+  voltageReading.accept(protoEncoder);
+  envelope.serializedData(protoEncoder.encodedData());
+  envelope.sent(sent);
+  envelope.sampleTimeStamp(
+      (0 == (sampleTime.seconds() + sampleTime.microseconds())) ? sent
+                                                                : sampleTime);
+  envelope.senderStamp(senderStamp);
+  return cluon::serializeEnvelope(std::move(envelope));
+}
+
+int32_t main(int32_t argc, char **argv) {
+  uint32_t const ITERATIONS{
+      (argc > 1) ? static_cast<uint32_t>(std::stoul(argv[1])) : 100000};
+
+  // Fake sysfs tree of the seven ADC channels, on tmpfs when available.
+  char shmDir[] = "/dev/shm/adc-bbblue-benchmark-XXXXXX";
+  char tmpDir[] = "/tmp/adc-bbblue-benchmark-XXXXXX";
+  char *dir{::mkdtemp(shmDir)};
+  if (nullptr == dir) {
+    dir = ::mkdtemp(tmpDir);
+  }
+  if (nullptr == dir) {
+    std::cerr << "Failed to create temporary directory." << std::endl;
+    return 1;
+  }
+  for (uint32_t channel{0}; channel < 7; channel++) {
+    std::ofstream node(std::string(dir) + "/in_voltage" +
+                       std::to_string(channel) + "_raw");
+    node << 3065 + channel << "\n";
+  }
+  std::string const CHANNELSTR{"6"};
+  std::string const PATH{std::string(dir) + "/in_voltage" + CHANNELSTR +
+                         "_raw"};
+  std::cout << "Fake sysfs tree in " << dir << ", " << ITERATIONS
+            << " iterations." << std::endl;
+
+  int32_t volatile sink{0};
+  float volatile voltage{12.6f};
+  size_t volatile size{0};
+  cluon::data::TimeStamp const SAMPLE_TIME{cluon::time::now()};
+
+  // Each stage of publishing one reading, in pipeline order.
+  std::cout << "Stages:" << std::endl;
+  benchmark("timer overhead (empty operation)", ITERATIONS, []() {});
+
+  benchmark("open+read+close", ITERATIONS, [&]() {
+    char buffer[16];
+    int32_t const FD{::open(PATH.c_str(), O_RDONLY | O_CLOEXEC)};
+    size = static_cast<size_t>(::read(FD, buffer, sizeof(buffer)));
+    ::close(FD);
+  });
+
+  int32_t const STAGE_FD{::open(PATH.c_str(), O_RDONLY | O_CLOEXEC)};
+  benchmark("pread on an open fd", ITERATIONS, [&]() {
+    char buffer[16];
+    size = static_cast<size_t>(::pread(STAGE_FD, buffer, sizeof(buffer), 0));
+  });
+  ::close(STAGE_FD);
+
+  std::string const RAW_TEXT{"3071\n"};
+  benchmark("parse with std::stoi", ITERATIONS,
+            [&]() { sink = std::stoi(RAW_TEXT); });
+  benchmark("parse with parseRawAdcValue", ITERATIONS, [&]() {
+    int32_t output{0};
+    parseRawAdcValue(RAW_TEXT.data(), RAW_TEXT.size(), output);
+    sink = output;
+  });
+
+  AdcChannelConfig stageConfig;
+  stageConfig.channel = 6;
+  stageConfig.conversion2Volt = 19.8f;
+  stageConfig.offset = -0.1f;
+  benchmark("conversion with toVoltage", ITERATIONS,
+            [&]() { voltage = toVoltage(stageConfig, sink); });
+
+  opendlv::proxy::VoltageReading stageReading;
+  stageReading.voltage(12.6f);
+  std::string encodedReading;
+  benchmark("ToProtoVisitor encode", ITERATIONS, [&]() {
+    cluon::ToProtoVisitor protoEncoder;
+    stageReading.accept(protoEncoder);
+    encodedReading = protoEncoder.encodedData();
+  });
+
+  std::string serializedEnvelope;
+  benchmark("Envelope+serializeEnvelope", ITERATIONS, [&]() {
+    cluon::data::Envelope envelope;
+    envelope.dataType(static_cast<int32_t>(stageReading.ID()));
+    envelope.serializedData(encodedReading);
+    envelope.sent(SAMPLE_TIME);
+    envelope.sampleTimeStamp(SAMPLE_TIME);
+    envelope.senderStamp(6);
+    serializedEnvelope = cluon::serializeEnvelope(std::move(envelope));
+  });
+
+  {
+    // A bound receiver that is never read; the kernel drops what overflows.
+    int32_t receiver{::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)};
+    struct sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressLength{sizeof(address)};
+    if (0 != ::bind(receiver, reinterpret_cast<struct sockaddr *>(&address),
+                    sizeof(address)) ||
+        0 != ::getsockname(receiver,
+                           reinterpret_cast<struct sockaddr *>(&address),
+                           &addressLength)) {
+      std::cerr << "Skipping UDPSender::send, no loopback socket."
+                << std::endl;
+    } else {
+      cluon::UDPSender loopbackSender{"127.0.0.1", ntohs(address.sin_port)};
+      std::string datagram;
+      datagram.reserve(serializedEnvelope.size());
+      benchmark("UDPSender::send on loopback", ITERATIONS / 10, [&]() {
+        datagram.assign(serializedEnvelope);
+        loopbackSender.send(std::move(datagram));
+      });
+    }
+    ::close(receiver);
+  }
+
+  {
+    std::vector<AdcChannelConfig> const SAMPLER_CONFIGS{
+        parseChannelConfigs("0,1,2,3,4,5,6", "", "")};
+    AdcSampler adcSampler(dir, SAMPLER_CONFIGS);
+    benchmark("AdcSampler tick of 7 channels", ITERATIONS / 10, [&]() {
+      int32_t output{0};
+      for (size_t i{0}; i < adcSampler.size(); i++) {
+        adcSampler.read(i, output);
+      }
+      sink = output;
+    });
+  }
+
+  std::cout << "Alternatives:" << std::endl;
+
+  // The previous implementation: reopen, getline and stoi on every tick.
+  benchmark("ifstream+getline+stoi", ITERATIONS, [&]() {
+    int32_t output{0};
+    std::ifstream adcNode(std::string(dir) + "/in_voltage" + CHANNELSTR +
+                          "_raw");
+    if (adcNode.is_open()) {
+      std::string str;
+      std::getline(adcNode, str);
+      output = std::stoi(str);
+    }
+    adcNode.close();
+    sink = output;
+  });
+
+  AdcChannel adcChannel(PATH);
+  benchmark("persistent fd+pread+parse", ITERATIONS, [&]() {
+    int32_t output{0};
+    adcChannel.read(output);
+    sink = output;
+  });
+
+  benchmark("ToProtoVisitor+Envelope+serializeEnvelope", ITERATIONS, [&]() {
+    size = encodeWithCluon(voltage, cluon::time::now(), SAMPLE_TIME, 6)
+               .size();
+  });
+
+  VoltageEnvelopeEncoder voltageEncoder{opendlv::proxy::VoltageReading::ID()};
+  benchmark("VoltageEnvelopeEncoder", ITERATIONS, [&]() {
+    char buffer[VoltageEnvelopeEncoder::MAX_SIZE];
+    cluon::data::TimeStamp const SENT{cluon::time::now()};
+    size = voltageEncoder.encode(buffer, voltage, SENT.seconds(),
+                                 SENT.microseconds(), SAMPLE_TIME.seconds(),
+                                 SAMPLE_TIME.microseconds(), 6);
+  });
+
+  int32_t retCode{0};
+
+  // Archive blocks of 1024 samples, as written with --archive.
+  {
+    AdcChannelConfig archiveConfig;
+    archiveConfig.channel = 6;
+    ArchiveBlockEncoder archiveBlock{archiveConfig, 1024, 1000000};
+    benchmark("ArchiveBlockEncoder 1024 samples", ITERATIONS / 100, [&]() {
+      archiveBlock.clear();
+      for (int32_t i{0}; i < 1024; i++) {
+        archiveBlock.add(3000 + (i * 7) % 32, 1000 * i);
+      }
+      size = archiveBlock.size();
+    });
+    ArchiveBlockHeader header;
+    std::vector<int32_t> raw(1024);
+    benchmark("decodeArchivePayload 1024 samples", ITERATIONS / 100, [&]() {
+      char const *data{archiveBlock.data()};
+      parseArchiveBlockHeader(data, archiveBlock.size(), header);
+      decodeArchivePayload(data + ARCHIVE_HEADER_SIZE, header.payloadSize,
+                           header.sampleCount, raw.data());
+    });
+    std::cout << "Archive block: " << archiveBlock.size()
+              << " bytes for 1024 samples." << std::endl;
+  }
+
+  // Local consumers: a shared-memory reader versus an OD4-style multicast
+  // datagram looped back to a socket in the same process.
+  std::vector<AdcChannelConfig> shmConfigs(1);
+  shmConfigs.front().channel = 6;
+  shmConfigs.front().senderStamp = 6;
+  std::string const SHM_NAME{"/adc-bbblue-benchmark-" +
+                             std::to_string(::getpid())};
+  {
+    SharedVoltageRing sharedVoltageRing{SHM_NAME, shmConfigs, 1024};
+    cluon::SharedMemory attached{SHM_NAME};
+    shared_voltage::Reader reader{attached.data(), attached.size()};
+    if (!sharedVoltageRing.isValid() || !reader.isValid()) {
+      std::cerr << "Failed to set up shared memory " << SHM_NAME << "."
+                << std::endl;
+      retCode = 1;
+    } else {
+      int64_t sampleTime{0};
+      benchmark("SharedVoltageRing write", ITERATIONS, [&]() {
+        sharedVoltageRing.write(0, voltage, ++sampleTime);
+      });
+      shared_voltage::Sample sample;
+      benchmark("shared_voltage::Reader latest", ITERATIONS, [&]() {
+        reader.latest(0, sample);
+      });
+      benchmark("SharedVoltageRing write+Reader latest", ITERATIONS, [&]() {
+        sharedVoltageRing.write(0, voltage, ++sampleTime);
+        reader.latest(0, sample);
+      });
+    }
+  }
+
+  {
+    std::string const GROUP{"225.0.0.250"};
+    uint16_t const PORT{12175};
+    int32_t receiver{::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)};
+    int32_t const REUSE{1};
+    ::setsockopt(receiver, SOL_SOCKET, SO_REUSEADDR, &REUSE, sizeof(REUSE));
+    struct timeval timeout {};
+    timeout.tv_sec = 1;
+    ::setsockopt(receiver, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    struct sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(PORT);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    struct ip_mreq membership {};
+    membership.imr_multiaddr.s_addr = ::inet_addr(GROUP.c_str());
+    membership.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (0 != ::bind(receiver, reinterpret_cast<struct sockaddr *>(&address),
+                    sizeof(address)) ||
+        0 != ::setsockopt(receiver, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership,
+                          sizeof(membership))) {
+      std::cerr << "Skipping multicast loopback, could not join " << GROUP
+                << "." << std::endl;
+    } else {
+      cluon::UDPSender udpSender{GROUP, PORT};
+      std::string datagram;
+      datagram.reserve(VoltageEnvelopeEncoder::MAX_SIZE);
+      bool isReceived{true};
+      benchmark("VoltageEnvelopeEncoder+multicast send+recv", ITERATIONS / 10,
+                [&]() {
+                  char buffer[VoltageEnvelopeEncoder::MAX_SIZE];
+                  cluon::data::TimeStamp const SENT{cluon::time::now()};
+                  datagram.assign(
+                      buffer, voltageEncoder.encode(
+                                  buffer, voltage, SENT.seconds(),
+                                  SENT.microseconds(), SAMPLE_TIME.seconds(),
+                                  SAMPLE_TIME.microseconds(), 6));
+                  udpSender.send(std::move(datagram));
+                  char received[VoltageEnvelopeEncoder::MAX_SIZE];
+                  isReceived = isReceived &&
+                               ::recv(receiver, received, sizeof(received), 0) > 0;
+                });
+      if (!isReceived) {
+        std::cerr << "Multicast datagrams were lost on loopback." << std::endl;
+      }
+    }
+    ::close(receiver);
+  }
+
+  int32_t value{0};
+  if (!adcChannel.read(value) || 3071 != value || 3071 != sink) {
+    std::cerr << "Unexpected value read from " << PATH << "." << std::endl;
+    retCode = 1;
+  }
+
+  for (uint32_t channel{0}; channel < 7; channel++) {
+    ::unlink((std::string(dir) + "/in_voltage" + std::to_string(channel) +
+              "_raw")
+                 .c_str());
+  }
+  ::rmdir(dir);
+  return retCode;
+}
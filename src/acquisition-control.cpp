@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <exception>
+#include <utility>
+
+#include "acquisition-control.hpp"
+
+namespace {
+// Moves the state of channels that are still sampled to their new index and
+// creates it for new channels.
+template <typename T, typename Create>
+void remap(std::vector<T> &states,
+           std::vector<AdcChannelConfig> const &configs,
+           std::vector<AdcChannelConfig> const &newConfigs, Create create) {
+  if (states.empty()) {
+    return;
+  }
+  std::vector<T> remapped;
+  remapped.reserve(newConfigs.size());
+  for (auto const &config : newConfigs) {
+    size_t index{0};
+    while (index < configs.size() && configs[index].channel != config.channel) {
+      index++;
+    }
+    if (index < configs.size()) {
+      remapped.push_back(std::move(states[index]));
+    } else {
+      remapped.push_back(create(config));
+    }
+  }
+  states = std::move(remapped);
+}
+}  // namespace
+
+AcquisitionControl::AcquisitionControl(AcquisitionState &state,
+                                       DeadlineScheduler &scheduler,
+                                       SamplerFactory openSampler,
+                                       bool isRateFixed,
+                                       bool areChannelsFixed) noexcept
+    : m_state(state),
+      m_scheduler(scheduler),
+      m_openSampler{std::move(openSampler)},
+      m_isRateFixed{isRateFixed},
+      m_areChannelsFixed{areChannelsFixed},
+      m_isPending{false},
+      m_request{},
+      m_configs{},
+      m_sampler{},
+      m_leases{},
+      m_idleFrequency{0.0f} {}
+
+void AcquisitionControl::enableLeases(float idleFrequency,
+                                      size_t capacity) noexcept {
+  m_idleFrequency = idleFrequency;
+  m_leases.reset(new SamplingLeases(capacity));
+}
+
+bool AcquisitionControl::hasLeases() const noexcept {
+  return m_leases != nullptr;
+}
+
+size_t AcquisitionControl::leases() const noexcept {
+  return m_leases ? m_leases->size() : 0;
+}
+
+bool AcquisitionControl::request(
+    opendlv::device::adc::AcquisitionRequest const &request,
+    std::string &reason) noexcept {
+  bool const CHANGES_SAMPLING{request.frequency() > 0.0f ||
+                              !request.channels().empty()};
+  if (CHANGES_SAMPLING && m_isRateFixed) {
+    reason = "the rate and channels of buffered capture are fixed";
+    return false;
+  }
+  if (!std::isfinite(request.frequency()) ||
+      request.frequency() > DeadlineScheduler::MAX_FREQUENCY ||
+      request.frequency() < 0.0f) {
+    reason = "not supported frequency " + std::to_string(request.frequency()) +
+             " Hz";
+    return false;
+  }
+  // Zero leaves a setting unchanged, anything else is checked before it is
+  // turned into microseconds.
+  if (!std::isfinite(request.heartbeat()) || request.heartbeat() < 0.0f ||
+      request.heartbeat() * 1000000.0f >
+          static_cast<float>(DeadbandFilter::MAX_HEARTBEAT)) {
+    reason = "not supported heartbeat " + std::to_string(request.heartbeat()) +
+             " s";
+    return false;
+  }
+  // A negative deadband turns the deadband off.
+  if (!std::isfinite(request.deadband())) {
+    reason = "not supported deadband " + std::to_string(request.deadband()) +
+             " V";
+    return false;
+  }
+  if (!std::isfinite(request.batchMs()) || request.batchMs() < 0.0f ||
+      request.batchMs() * 1000.0f >
+          static_cast<float>(VoltageBatch::MAX_AGE)) {
+    reason = "not supported batch age " + std::to_string(request.batchMs()) +
+             " ms";
+    return false;
+  }
+  if (!request.channels().empty()) {
+    if (m_areChannelsFixed) {
+      reason = "the channels of the shared memory are fixed";
+      return false;
+    }
+    std::vector<AdcChannelConfig> newConfigs;
+    try {
+      newConfigs = parseChannelConfigs(request.channels(), request.ids(),
+                                       request.conversions());
+    } catch (std::exception const &e) {
+      reason = e.what();
+      return false;
+    }
+    m_sampler = m_openSampler(newConfigs);
+    m_configs = std::move(newConfigs);
+  }
+  // With leases, a new rate is the idle rate that they may raise.
+  if (request.frequency() > 0.0f && m_leases) {
+    m_idleFrequency = request.frequency();
+    requestLeasedRate();
+  } else if (request.frequency() > 0.0f) {
+    m_request.frequency(request.frequency());
+  }
+  if (0.0f < request.deadband() || 0.0f > request.deadband()) {
+    m_request.deadband(request.deadband());
+  }
+  if (request.heartbeat() > 0.0f) {
+    m_request.heartbeat(request.heartbeat());
+  }
+  if (request.batch() > 0) {
+    m_request.batch(request.batch());
+  }
+  if (request.batchMs() > 0.0f) {
+    m_request.batchMs(request.batchMs());
+  }
+  m_isPending = true;
+  return true;
+}
+
+bool AcquisitionControl::lease(
+    uint32_t holder, opendlv::device::adc::SamplingLease const &request,
+    int64_t now, std::string &reason) noexcept {
+  if (!m_leases) {
+    reason = "leases are off";
+    return false;
+  }
+  bool isSampled{false};
+  for (auto const &config : m_state.configs) {
+    isSampled = isSampled || config.channel == request.channel();
+  }
+  SamplingLease lease;
+  if (!isSampled ||
+      !makeSamplingLease(holder, request.channel(), request.frequency(),
+                         request.duration(), DeadlineScheduler::MAX_FREQUENCY,
+                         now, lease)) {
+    reason = "channel not sampled, or rate or duration not supported";
+    return false;
+  }
+  if (!m_leases->grant(lease, now)) {
+    reason = "too many leases";
+    return false;
+  }
+  requestLeasedRate();
+  return true;
+}
+
+void AcquisitionControl::expireLeases(int64_t now) noexcept {
+  if (m_leases && m_leases->expire(now)) {
+    requestLeasedRate();
+  }
+}
+
+bool AcquisitionControl::isPending() const noexcept {
+  return m_isPending;
+}
+
+void AcquisitionControl::requestLeasedRate() noexcept {
+  float const FREQUENCY{m_leases->frequency(m_idleFrequency)};
+  if (m_request.frequency() > 0.0f ||
+      DeadlineScheduler::periodFromFrequency(FREQUENCY) !=
+          m_scheduler.period()) {
+    m_request.frequency(FREQUENCY);
+    m_isPending = true;
+  }
+}
+
+void AcquisitionControl::apply(
+    std::function<void(size_t index)> const &retire) noexcept {
+  if (!m_isPending) {
+    return;
+  }
+  m_isPending = false;
+  opendlv::device::adc::AcquisitionRequest const REQUEST{m_request};
+  m_request = opendlv::device::adc::AcquisitionRequest{};
+  AcquisitionState &state{m_state};
+
+  if (m_sampler) {
+    for (size_t i{0}; i < state.configs.size(); i++) {
+      bool isKept{false};
+      for (auto const &config : m_configs) {
+        isKept = isKept || config.channel == state.configs[i].channel;
+      }
+      if (!isKept) {
+        retire(i);
+      }
+    }
+    remap(state.statistics, state.configs, m_configs,
+          [&state](AdcChannelConfig const &) {
+            return VoltageStatistics(state.summaryWindow);
+          });
+    remap(state.alarms, state.configs, m_configs,
+          [&state](AdcChannelConfig const &config) {
+            std::vector<VoltageAlarm> channelAlarms;
+            for (auto const &rule : state.alarmRules) {
+              if (rule.channel == config.channel) {
+                channelAlarms.emplace_back(rule);
+              }
+            }
+            return channelAlarms;
+          });
+    remap(state.batches, state.configs, m_configs,
+          [&state, this](AdcChannelConfig const &) {
+            return VoltageBatch(state.batchSize, state.batchAge,
+                                m_scheduler.period());
+          });
+    remap(state.deadbands, state.configs, m_configs,
+          [&state](AdcChannelConfig const &) {
+            return DeadbandFilter(state.deadband, state.heartbeat);
+          });
+    remap(state.health, state.configs, m_configs,
+          [](AdcChannelConfig const &) { return ChannelHealth(); });
+    state.configs = std::move(m_configs);
+    m_configs.clear();
+    state.sampler = std::move(m_sampler);
+    state.outputs.assign(state.configs.size(), 0);
+  }
+
+  if (REQUEST.frequency() > 0.0f) {
+    m_scheduler.setPeriod(
+        DeadlineScheduler::periodFromFrequency(REQUEST.frequency()));
+  }
+
+  if (1 == REQUEST.batch()) {
+    state.batchSize = 0;
+    state.batchAge = 0;
+  } else if (REQUEST.batch() > 1 || REQUEST.batchMs() > 0.0f) {
+    if (REQUEST.batch() > 1) {
+      state.batchSize = REQUEST.batch();
+    }
+    if (REQUEST.batchMs() > 0.0f) {
+      state.batchAge = static_cast<int64_t>(REQUEST.batchMs() * 1000.0f);
+    }
+    if (0 == state.batchSize) {
+      state.batchSize = VoltageBatch::MAX_SAMPLES;
+    }
+  }
+  if (0 == state.batchSize) {
+    state.batches.clear();
+  } else if (state.batches.empty()) {
+    for (size_t i{0}; i < state.configs.size(); i++) {
+      state.batches.emplace_back(state.batchSize, state.batchAge,
+                                 m_scheduler.period());
+    }
+  } else {
+    for (auto &batch : state.batches) {
+      batch.reconfigure(state.batchSize, state.batchAge, m_scheduler.period());
+    }
+  }
+
+  if (REQUEST.heartbeat() > 0.0f) {
+    state.heartbeat = static_cast<int64_t>(REQUEST.heartbeat() * 1000000.0f);
+  }
+  if (REQUEST.deadband() < 0.0f) {
+    state.deadbands.clear();
+  } else if (REQUEST.deadband() > 0.0f ||
+             (REQUEST.heartbeat() > 0.0f && !state.deadbands.empty())) {
+    if (REQUEST.deadband() > 0.0f) {
+      state.deadband = REQUEST.deadband();
+    }
+    state.deadbands.clear();
+    for (size_t i{0}; i < state.configs.size(); i++) {
+      state.deadbands.emplace_back(state.deadband, state.heartbeat);
+    }
+  }
+
+  // Blocks carry the channel configuration and sample period, so they are
+  // started over.
+  if (!state.archiveBlocks.empty()) {
+    state.archiveBlocks.clear();
+    for (auto const &config : state.configs) {
+      state.archiveBlocks.emplace_back(config, state.archiveBlock,
+                                       m_scheduler.period());
+    }
+  }
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ACQUISITION_CONTROL_HPP
+#define ACQUISITION_CONTROL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "adc-sampler.hpp"
+#include "channel-health.hpp"
+#include "cluon-complete.hpp"
+#include "deadband.hpp"
+#include "deadline-scheduler.hpp"
+#include "opendlv-device-adc-bbblue-message-set.hpp"
+#include "raw-archive.hpp"
+#include "sampling-leases.hpp"
+#include "voltage-alarm.hpp"
+#include "voltage-batch.hpp"
+#include "voltage-statistics.hpp"
+
+/**
+ * What runtime reconfiguration changes: the sampled channels with their
+ * per-channel state, index-aligned with configs, and the settings that the
+ * state of new channels is created with. A per-channel vector left empty
+ * means that its feature is off.
+ */
+struct AcquisitionState {
+  std::vector<AdcChannelConfig> configs{};
+  std::unique_ptr<AdcSampler> sampler{};
+  std::vector<int32_t> outputs{};
+  std::vector<ChannelHealth> health{};
+  std::vector<VoltageStatistics> statistics{};
+  std::vector<std::vector<VoltageAlarm>> alarms{};
+  std::vector<VoltageBatch> batches{};
+  std::vector<DeadbandFilter> deadbands{};
+  std::vector<ArchiveBlockEncoder> archiveBlocks{};
+  int64_t summaryWindow{0};  // Microseconds.
+  std::vector<AlarmRule> alarmRules{};
+  uint32_t batchSize{0};
+  int64_t batchAge{0};  // Microseconds.
+  float deadband{0.0f};
+  int64_t heartbeat{1000000};  // Microseconds.
+  uint16_t archiveBlock{1024};
+};
+
+/**
+ * Changes the acquisition at runtime through
+ * opendlv.device.adc.AcquisitionRequest and, with leases,
+ * opendlv.device.adc.SamplingLease. A request is checked and prepared when it
+ * arrives, including opening new channels, and applied as a whole by apply()
+ * at the start of the next tick; per-sample code never sees a half-applied
+ * configuration. Requests arriving within the same tick are merged, later
+ * fields taking precedence, and channels that are dropped are handed to the
+ * delegate of apply() while their state is still in place. With leases, the
+ * rate is the highest leased one, or the idle rate once all have expired.
+ */
+class AcquisitionControl {
+ private:
+  AcquisitionControl(AcquisitionControl const &) = delete;
+  AcquisitionControl(AcquisitionControl &&) = delete;
+  AcquisitionControl &operator=(AcquisitionControl const &) = delete;
+  AcquisitionControl &operator=(AcquisitionControl &&) = delete;
+
+ public:
+  using SamplerFactory = std::function<std::unique_ptr<AdcSampler>(
+      std::vector<AdcChannelConfig> const &configs)>;
+
+ public:
+  AcquisitionControl(AcquisitionState &state, DeadlineScheduler &scheduler,
+                     SamplerFactory openSampler, bool isRateFixed,
+                     bool areChannelsFixed) noexcept;
+  ~AcquisitionControl() = default;
+
+ public:
+  void enableLeases(float idleFrequency, size_t capacity) noexcept;
+  bool hasLeases() const noexcept;
+  size_t leases() const noexcept;
+  bool request(opendlv::device::adc::AcquisitionRequest const &request,
+               std::string &reason) noexcept;
+  bool lease(uint32_t holder,
+             opendlv::device::adc::SamplingLease const &request, int64_t now,
+             std::string &reason) noexcept;
+  void expireLeases(int64_t now) noexcept;
+  bool isPending() const noexcept;
+  void apply(std::function<void(size_t index)> const &retire) noexcept;
+
+ private:
+  void requestLeasedRate() noexcept;
+
+ private:
+  AcquisitionState &m_state;
+  DeadlineScheduler &m_scheduler;
+  SamplerFactory m_openSampler;
+  bool m_isRateFixed;
+  bool m_areChannelsFixed;
+  bool m_isPending;
+  opendlv::device::adc::AcquisitionRequest m_request;
+  std::vector<AdcChannelConfig> m_configs;
+  std::unique_ptr<AdcSampler> m_sampler;
+  std::unique_ptr<SamplingLeases> m_leases;
+  float m_idleFrequency;
+};
+
+#endif
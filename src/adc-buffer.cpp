@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "adc-buffer.hpp"
+
+bool parseScanElementType(std::string const &type, AdcScanElement &element) noexcept {
+  char endianness[3]{0, 0, 0};
+  char sign{0};
+  uint32_t realBits{0};
+  uint32_t storageBits{0};
+  uint32_t shift{0};
+  if (5 != std::sscanf(type.c_str(), "%2[bl]e:%c%u/%u>>%u", endianness, &sign,
+                       &realBits, &storageBits, &shift)) {
+    return false;
+  }
+  if ((sign != 's' && sign != 'u') || realBits == 0 || realBits > 32 ||
+      (storageBits != 8 && storageBits != 16 && storageBits != 32) ||
+      realBits + shift > storageBits) {
+    return false;
+  }
+  element.isBigEndian = (endianness[0] == 'b');
+  element.isSigned = (sign == 's');
+  element.realBits = static_cast<uint8_t>(realBits);
+  element.storageBits = static_cast<uint8_t>(storageBits);
+  element.shift = static_cast<uint8_t>(shift);
+  return true;
+}
+
+uint32_t const AdcBuffer::MAX_LENGTH;
+
+AdcBuffer::AdcBuffer(std::string const &iioDevicePath,
+                     std::string const &devicePath,
+                     std::vector<uint8_t> const &channels, float frequency,
+                     uint32_t length) noexcept
+    : m_iioDevicePath{iioDevicePath},
+      m_elements{},
+      m_channelToElement{},
+      m_buffer{},
+      m_scanSize{0},
+      m_samplingFrequency{frequency},
+      m_pending{0},
+      m_scansInBuffer{0},
+      m_isEnabled{false},
+      m_isRegularFile{false},
+      m_isEndOfStream{false},
+      m_fd{-1} {
+  // The buffer must be disabled while the scan is being reconfigured.
+  writeAttribute("buffer/enable", "0");
+  for (uint8_t channel{0}; channel < 8; channel++) {
+    bool const IS_WANTED{channels.end() !=
+                         std::find(channels.begin(), channels.end(), channel)};
+    std::string const PREFIX{"scan_elements/in_voltage" +
+                             std::to_string(channel)};
+    writeAttribute(PREFIX + "_en", IS_WANTED ? "1" : "0");
+  }
+
+  std::vector<std::pair<uint32_t, AdcScanElement>> indexed;
+  for (uint8_t channel : channels) {
+    std::string const PREFIX{"scan_elements/in_voltage" +
+                             std::to_string(channel)};
+    AdcScanElement element;
+    element.channel = channel;
+    std::string const TYPE{readAttribute(PREFIX + "_type")};
+    if (!TYPE.empty() && !parseScanElementType(TYPE, element)) {
+      std::cerr << "Unsupported scan element type '" << TYPE
+                << "' for channel " << +channel << "." << std::endl;
+    }
+    uint32_t index{channel};
+    std::string const INDEX{readAttribute(PREFIX + "_index")};
+    if (!INDEX.empty()) {
+      index = static_cast<uint32_t>(std::strtoul(INDEX.c_str(), nullptr, 10));
+    }
+    indexed.emplace_back(index, element);
+  }
+  // Scan elements are packed in ascending scan index, each aligned to its
+  // size, and the scan is padded to a multiple of the largest element.
+  std::sort(indexed.begin(), indexed.end(),
+            [](std::pair<uint32_t, AdcScanElement> const &a,
+               std::pair<uint32_t, AdcScanElement> const &b) {
+              return a.first < b.first;
+            });
+  size_t largest{1};
+  for (auto &entry : indexed) {
+    size_t const BYTES{entry.second.storageBits / 8u};
+    m_scanSize = (m_scanSize + BYTES - 1) / BYTES * BYTES;
+    entry.second.offset = m_scanSize;
+    m_scanSize += BYTES;
+    largest = std::max(largest, BYTES);
+    m_elements.push_back(entry.second);
+  }
+  m_scanSize = (m_scanSize + largest - 1) / largest * largest;
+  for (uint8_t channel : channels) {
+    for (size_t i{0}; i < m_elements.size(); i++) {
+      if (m_elements[i].channel == channel) {
+        m_channelToElement.push_back(i);
+        break;
+      }
+    }
+  }
+  if (0 == m_scanSize) {
+    return;
+  }
+  m_buffer.resize(static_cast<size_t>(std::max<uint32_t>(length, 1)) *
+                  m_scanSize);
+
+  // Written as a whole number where it is one, as not all drivers take
+  // fractions.
+  float const WHOLE{std::round(frequency)};
+  writeAttribute("sampling_frequency",
+                 (0.0f < std::fabs(frequency - WHOLE))
+                     ? std::to_string(frequency)
+                     : std::to_string(static_cast<int64_t>(WHOLE)));
+  std::string const FREQUENCY{readAttribute("sampling_frequency")};
+  if (!FREQUENCY.empty()) {
+    float const REPORTED{std::strtof(FREQUENCY.c_str(), nullptr)};
+    if (REPORTED > 0.0f) {
+      m_samplingFrequency = REPORTED;
+    }
+  }
+
+  writeAttribute("buffer/length", std::to_string(length));
+  m_isEnabled = writeAttribute("buffer/enable", "1");
+
+  // Non-blocking, so that a FIFO without writer does not block startup.
+  m_fd = ::open(devicePath.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  struct stat status;
+  if (m_fd >= 0 && 0 == ::fstat(m_fd, &status)) {
+    m_isRegularFile = S_ISREG(status.st_mode);
+    if (S_ISFIFO(status.st_mode)) {
+      // Holding the write end as well keeps the FIFO from signalling hang-up
+      // while no simulator is attached.
+      ::close(m_fd);
+      m_fd = ::open(devicePath.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    }
+  }
+}
+
+AdcBuffer::~AdcBuffer() noexcept {
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+  if (m_isEnabled) {
+    writeAttribute("buffer/enable", "0");
+  }
+}
+
+bool AdcBuffer::isOpen() const noexcept {
+  return m_fd >= 0;
+}
+
+int32_t AdcBuffer::fd() const noexcept {
+  return m_fd;
+}
+
+size_t AdcBuffer::channelCount() const noexcept {
+  return m_channelToElement.size();
+}
+
+size_t AdcBuffer::scanSize() const noexcept {
+  return m_scanSize;
+}
+
+float AdcBuffer::samplingFrequency() const noexcept {
+  return m_samplingFrequency;
+}
+
+bool AdcBuffer::isEndOfStream() const noexcept {
+  return m_isEndOfStream;
+}
+
+int32_t AdcBuffer::read() noexcept {
+  if (m_fd < 0) {
+    return -1;
+  }
+  // Keep the trailing bytes of an incomplete scan from the previous read.
+  if (m_pending > 0 && m_scansInBuffer > 0) {
+    std::memmove(m_buffer.data(), m_buffer.data() + m_scansInBuffer * m_scanSize,
+                 m_pending);
+  }
+  m_scansInBuffer = 0;
+
+  ssize_t n;
+  do {
+    n = ::read(m_fd, m_buffer.data() + m_pending, m_buffer.size() - m_pending);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) {
+    return (errno == EAGAIN) ? 0 : -1;
+  }
+  if (n == 0) {
+    m_isEndOfStream = m_isRegularFile;
+    return 0;
+  }
+  size_t const TOTAL{m_pending + static_cast<size_t>(n)};
+  m_scansInBuffer = TOTAL / m_scanSize;
+  m_pending = TOTAL - m_scansInBuffer * m_scanSize;
+  return static_cast<int32_t>(m_scansInBuffer);
+}
+
+int32_t AdcBuffer::raw(size_t scan, size_t channelIndex) const noexcept {
+  AdcScanElement const &element{
+      m_elements[m_channelToElement[channelIndex]]};
+  uint8_t const *data{m_buffer.data() + scan * m_scanSize + element.offset};
+  size_t const BYTES{element.storageBits / 8u};
+  uint32_t value{0};
+  for (size_t i{0}; i < BYTES; i++) {
+    size_t const BYTE{element.isBigEndian ? i : BYTES - 1 - i};
+    value = (value << 8) | data[BYTE];
+  }
+  value >>= element.shift;
+  uint32_t const MASK{(element.realBits == 32)
+                          ? 0xffffffffu
+                          : ((1u << element.realBits) - 1u)};
+  value &= MASK;
+  if (element.isSigned && (value & (1u << (element.realBits - 1)))) {
+    value |= ~MASK;
+  }
+  return static_cast<int32_t>(value);
+}
+
+bool AdcBuffer::writeAttribute(std::string const &name,
+                               std::string const &value) const noexcept {
+  // Opened without truncating, so that a missing attribute is not created.
+  std::ofstream attribute(m_iioDevicePath + "/" + name,
+                          std::ios::in | std::ios::out);
+  if (!attribute.is_open()) {
+    return false;
+  }
+  attribute << value;
+  attribute.flush();
+  return attribute.good();
+}
+
+std::string AdcBuffer::readAttribute(std::string const &name) const noexcept {
+  std::string value;
+  std::ifstream attribute(m_iioDevicePath + "/" + name);
+  if (attribute.is_open()) {
+    std::getline(attribute, value);
+  }
+  return value;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADC_BUFFER_HPP
+#define ADC_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Layout of one channel inside a packed IIO scan, as described by
+ * scan_elements/in_voltageN_type (for example "le:u12/16>>0").
+ */
+struct AdcScanElement {
+  uint8_t channel{0};
+  bool isBigEndian{false};
+  bool isSigned{false};
+  uint8_t realBits{12};
+  uint8_t storageBits{16};
+  uint8_t shift{0};
+  size_t offset{0};
+};
+
+bool parseScanElementType(std::string const &type, AdcScanElement &element) noexcept;
+
+/**
+ * Buffered capture from the IIO character device. The selected channels are
+ * enabled under scan_elements/, the sampling frequency is requested, the
+ * kernel buffer is sized and enabled, and packed scans are then read in blocks
+ * from the device node. samplingFrequency() is the rate the device reports
+ * back, as a driver may round the requested one, or the requested rate if the
+ * device has no such attribute. The device node
+ * may also be a FIFO or a plain file holding scans in the same format, in
+ * which case missing sysfs attributes are ignored.
+ */
+class AdcBuffer {
+ private:
+  AdcBuffer(AdcBuffer const &) = delete;
+  AdcBuffer(AdcBuffer &&) = delete;
+  AdcBuffer &operator=(AdcBuffer const &) = delete;
+  AdcBuffer &operator=(AdcBuffer &&) = delete;
+
+ public:
+  // Scans the kernel buffer holds at most.
+  static uint32_t const MAX_LENGTH{1048576};
+
+ public:
+  AdcBuffer(std::string const &iioDevicePath, std::string const &devicePath,
+            std::vector<uint8_t> const &channels, float frequency,
+            uint32_t length) noexcept;
+  ~AdcBuffer() noexcept;
+
+ public:
+  bool isOpen() const noexcept;
+  int32_t fd() const noexcept;
+  size_t channelCount() const noexcept;
+  size_t scanSize() const noexcept;
+  float samplingFrequency() const noexcept;
+  int32_t read() noexcept;
+  int32_t raw(size_t scan, size_t channelIndex) const noexcept;
+  bool isEndOfStream() const noexcept;
+
+ private:
+  bool writeAttribute(std::string const &name, std::string const &value) const noexcept;
+  std::string readAttribute(std::string const &name) const noexcept;
+
+ private:
+  std::string m_iioDevicePath;
+  std::vector<AdcScanElement> m_elements;
+  std::vector<size_t> m_channelToElement;
+  std::vector<uint8_t> m_buffer;
+  size_t m_scanSize;
+  float m_samplingFrequency;
+  size_t m_pending;
+  size_t m_scansInBuffer;
+  bool m_isEnabled;
+  bool m_isRegularFile;
+  bool m_isEndOfStream;
+  int32_t m_fd;
+};
+
+#endif
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <limits>
+
+#include "adc-channel.hpp"
+
+bool parseRawAdcValue(char const *buffer, size_t length, int32_t &value) noexcept {
+  size_t i{0};
+  while (i < length && (buffer[i] == ' ' || buffer[i] == '\t')) {
+    i++;
+  }
+  int64_t result{0};
+  size_t const FIRST_DIGIT{i};
+  while (i < length && buffer[i] >= '0' && buffer[i] <= '9') {
+    result = result * 10 + (buffer[i] - '0');
+    if (result > std::numeric_limits<int32_t>::max()) {
+      return false;
+    }
+    i++;
+  }
+  if (i == FIRST_DIGIT) {
+    return false;
+  }
+  value = static_cast<int32_t>(result);
+  return true;
+}
+
+uint32_t const AdcChannel::MAX_CONSECUTIVE_ERRORS;
+
+AdcChannel::AdcChannel(std::string const &path) noexcept
+    : m_path{path},
+      m_fd{-1},
+      m_lastError{0},
+      m_consecutiveErrors{0} {
+  open();
+}
+
+AdcChannel::~AdcChannel() noexcept {
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+}
+
+bool AdcChannel::isOpen() const noexcept {
+  return m_fd >= 0;
+}
+
+std::string const &AdcChannel::path() const noexcept {
+  return m_path;
+}
+
+bool AdcChannel::read(int32_t &value) noexcept {
+  if (m_fd < 0 && !open()) {
+    return false;
+  }
+  // A raw 12-bit code plus newline fits easily; sysfs re-samples on offset 0.
+  char buffer[16];
+  ssize_t n;
+  do {
+    n = ::pread(m_fd, buffer, sizeof(buffer), 0);
+  } while (n < 0 && errno == EINTR);
+  if (n <= 0) {
+    fail((n < 0) ? errno : ENODATA);
+    return false;
+  }
+  if (!parseRawAdcValue(buffer, static_cast<size_t>(n), value)) {
+    fail(EBADMSG);
+    return false;
+  }
+  m_consecutiveErrors = 0;
+  return true;
+}
+
+int32_t AdcChannel::lastError() const noexcept {
+  return m_lastError;
+}
+
+bool AdcChannel::open() noexcept {
+  m_fd = ::open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (m_fd < 0) {
+    m_lastError = errno;
+    return false;
+  }
+  m_consecutiveErrors = 0;
+  return true;
+}
+
+void AdcChannel::fail(int32_t error) noexcept {
+  m_lastError = error;
+  m_consecutiveErrors++;
+  if (m_consecutiveErrors >= MAX_CONSECUTIVE_ERRORS) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADC_CHANNEL_HPP
+#define ADC_CHANNEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Parses a non-negative decimal number from a sysfs attribute buffer without
+ * allocating. Leading whitespace is skipped and parsing stops at the first
+ * non-digit. Returns false if no digit was found or the value overflows.
+ */
+bool parseRawAdcValue(char const *buffer, size_t length, int32_t &value) noexcept;
+
+/**
+ * One ADC channel exposed as in_voltageN_raw through the IIO sysfs interface.
+ * The node is opened once and then sampled with pread(), so that a tick costs
+ * a single syscall and no heap allocations. After a failed read, lastError()
+ * tells why: the errno of the open or read, ENODATA for an empty read, or
+ * EBADMSG for content that is not a number.
+ *
+ * A node that failed to open is opened again on the next read, and after
+ * MAX_CONSECUTIVE_ERRORS failed reads in a row the node is closed to be
+ * reopened, so that a driver that was reloaded or came up late is picked up.
+ */
+class AdcChannel {
+ private:
+  AdcChannel(AdcChannel const &) = delete;
+  AdcChannel(AdcChannel &&) = delete;
+  AdcChannel &operator=(AdcChannel const &) = delete;
+  AdcChannel &operator=(AdcChannel &&) = delete;
+
+ public:
+  AdcChannel(std::string const &path) noexcept;
+  ~AdcChannel() noexcept;
+
+ public:
+  bool isOpen() const noexcept;
+  std::string const &path() const noexcept;
+  bool read(int32_t &value) noexcept;
+  int32_t lastError() const noexcept;
+
+ public:
+  static uint32_t const MAX_CONSECUTIVE_ERRORS{3};
+
+ private:
+  bool open() noexcept;
+  void fail(int32_t error) noexcept;
+
+ private:
+  std::string m_path;
+  int32_t m_fd;
+  int32_t m_lastError;
+  uint32_t m_consecutiveErrors;
+};
+
+#endif
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <stdexcept>
+
+#include "adc-sampler.hpp"
+
+// Lipo jack channel 6, conversion: 1.8*11 = 19.8
+// DC jack channel 5, conversion: 1.8*11 = 19.8
+
+static std::vector<std::string> split(std::string const &str) {
+  std::vector<std::string> tokens;
+  std::stringstream sstr(str);
+  std::string token;
+  while (std::getline(sstr, token, ',')) {
+    if (!token.empty()) {
+      tokens.push_back(token);
+    }
+  }
+  return tokens;
+}
+
+std::vector<AdcChannelConfig> parseChannelConfigs(
+    std::string const &channels, std::string const &ids,
+    std::string const &conversions) {
+  std::vector<std::string> const CHANNELS{split(channels)};
+  std::vector<std::string> const IDS{split(ids)};
+  std::vector<std::string> const CONVERSIONS{split(conversions)};
+  if (CHANNELS.empty()) {
+    throw std::invalid_argument("No channel given.");
+  }
+  if (IDS.size() > 1 && IDS.size() != CHANNELS.size()) {
+    throw std::invalid_argument("Give one id, or one id per channel.");
+  }
+  if (CONVERSIONS.size() > 1 && CONVERSIONS.size() != CHANNELS.size()) {
+    throw std::invalid_argument(
+        "Give one conversion factor, or one per channel.");
+  }
+
+  std::vector<AdcChannelConfig> configs;
+  for (size_t i{0}; i < CHANNELS.size(); i++) {
+    int32_t const CHANNEL{std::stoi(CHANNELS[i])};
+    if (CHANNEL < 0 || CHANNEL > 6) {
+      throw std::invalid_argument(
+          "Not supported channel number, must be between 0 and 6.");
+    }
+    for (auto const &config : configs) {
+      if (config.channel == CHANNEL) {
+        throw std::invalid_argument("Channel " + CHANNELS[i] +
+                                    " given more than once.");
+      }
+    }
+
+    AdcChannelConfig config;
+    config.channel = static_cast<uint8_t>(CHANNEL);
+    if (IDS.size() == CHANNELS.size()) {
+      config.senderStamp = static_cast<uint32_t>(std::stoul(IDS[i]));
+    } else if (IDS.size() == 1) {
+      config.senderStamp = static_cast<uint32_t>(std::stoul(IDS[0]) + i);
+    } else {
+      config.senderStamp = static_cast<uint32_t>(i);
+    }
+    if (config.channel < 5) {
+      config.conversion2Volt = 1.8f;
+    } else {
+      config.conversion2Volt = 19.8f;
+    }
+    if (config.channel == 5) {
+      config.offset = -0.15f;
+    } else if (config.channel == 6) {
+      config.offset = -0.1f;
+    }
+    if (!CONVERSIONS.empty()) {
+      config.conversion2Volt =
+          std::stof(CONVERSIONS[(CONVERSIONS.size() == 1) ? 0 : i]);
+    }
+    configs.push_back(config);
+  }
+  return configs;
+}
+
+float toVoltage(AdcChannelConfig const &config, int32_t raw) noexcept {
+  return raw * config.conversion2Volt / 4095.0f + config.offset;
+}
+
+AdcSampler::AdcSampler(std::string const &iioDevicePath,
+                       std::vector<AdcChannelConfig> const &configs) noexcept
+    : m_configs{configs},
+      m_channels{} {
+  for (auto const &config : m_configs) {
+    m_channels.emplace_back(new AdcChannel(
+        iioDevicePath + "/in_voltage" + std::to_string(config.channel) +
+        "_raw"));
+  }
+}
+
+size_t AdcSampler::size() const noexcept {
+  return m_configs.size();
+}
+
+AdcChannelConfig const &AdcSampler::config(size_t index) const noexcept {
+  return m_configs[index];
+}
+
+AdcChannel const &AdcSampler::channel(size_t index) const noexcept {
+  return *m_channels[index];
+}
+
+bool AdcSampler::read(size_t index, int32_t &raw) noexcept {
+  return m_channels[index]->read(raw);
+}
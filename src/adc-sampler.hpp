@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADC_SAMPLER_HPP
+#define ADC_SAMPLER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "adc-channel.hpp"
+
+/**
+ * Per-channel acquisition settings: which ADC input to read, the senderStamp
+ * used when publishing it, and how to convert a 12-bit code into volts.
+ */
+struct AdcChannelConfig {
+  uint8_t channel{0};
+  uint32_t senderStamp{0};
+  float conversion2Volt{1.8f};
+  float offset{0.0f};
+};
+
+/**
+ * Builds the channel configurations from the comma-separated --channel, --id
+ * and --conversion arguments. A single id is used as base for consecutive
+ * senderStamps; a single conversion factor applies to all channels. Throws
+ * std::invalid_argument on malformed or unsupported input.
+ */
+std::vector<AdcChannelConfig> parseChannelConfigs(std::string const &channels,
+                                                  std::string const &ids,
+                                                  std::string const &conversions);
+
+float toVoltage(AdcChannelConfig const &config, int32_t raw) noexcept;
+
+/**
+ * Reads all configured channels through the sysfs interface in one tick.
+ */
+class AdcSampler {
+ private:
+  AdcSampler(AdcSampler const &) = delete;
+  AdcSampler(AdcSampler &&) = delete;
+  AdcSampler &operator=(AdcSampler const &) = delete;
+  AdcSampler &operator=(AdcSampler &&) = delete;
+
+ public:
+  AdcSampler(std::string const &iioDevicePath,
+             std::vector<AdcChannelConfig> const &configs) noexcept;
+  ~AdcSampler() = default;
+
+ public:
+  size_t size() const noexcept;
+  AdcChannelConfig const &config(size_t index) const noexcept;
+  AdcChannel const &channel(size_t index) const noexcept;
+  bool read(size_t index, int32_t &raw) noexcept;
+
+ private:
+  std::vector<AdcChannelConfig> m_configs;
+  std::vector<std::unique_ptr<AdcChannel>> m_channels;
+};
+
+#endif
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "channel-health.hpp"
+
+ChannelHealth::ChannelHealth() noexcept
+    : m_isHealthy{true},
+      m_lastError{0},
+      m_samples{0},
+      m_failures{0} {}
+
+// Returns true when the read changes the channel from healthy to failing or
+// back, so that callers can log transitions instead of every failed tick.
+bool ChannelHealth::addRead(int32_t error) noexcept {
+  bool const WAS_HEALTHY{m_isHealthy};
+  m_isHealthy = (0 == error);
+  if (m_isHealthy) {
+    m_samples++;
+  } else {
+    m_failures++;
+    m_lastError = error;
+  }
+  return WAS_HEALTHY != m_isHealthy;
+}
+
+void ChannelHealth::clearWindow() noexcept {
+  m_samples = 0;
+  m_failures = 0;
+}
+
+bool ChannelHealth::isHealthy() const noexcept {
+  return m_isHealthy;
+}
+
+int32_t ChannelHealth::lastError() const noexcept {
+  return m_lastError;
+}
+
+int32_t ChannelHealth::statusCode() const noexcept {
+  // Only reads with a non-zero error count as failures.
+  return (0 == m_failures) ? 0 : m_lastError;
+}
+
+uint64_t ChannelHealth::samples() const noexcept {
+  return m_samples;
+}
+
+uint64_t ChannelHealth::failures() const noexcept {
+  return m_failures;
+}
+
+float ChannelHealth::errorRate() const noexcept {
+  uint64_t const READS{m_samples + m_failures};
+  return (0 == READS) ? 0.0f
+                      : static_cast<float>(m_failures) /
+                            static_cast<float>(READS);
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNEL_HEALTH_HPP
+#define CHANNEL_HEALTH_HPP
+
+#include <cstdint>
+
+/**
+ * Read health of one channel: whether its latest read succeeded, the error
+ * code of its latest failure, and the successful and failed reads of the
+ * current health window. A failed read is not published, so consumers learn
+ * about a dead ADC from the health messages instead of from a 0 V reading.
+ * statusCode() is the code of the channel's health message for the window:
+ * 0 when no read failed, and otherwise the last error, which is never 0.
+ */
+class ChannelHealth {
+ private:
+  ChannelHealth(ChannelHealth const &) = delete;
+  ChannelHealth &operator=(ChannelHealth const &) = delete;
+  ChannelHealth &operator=(ChannelHealth &&) = delete;
+
+ public:
+  ChannelHealth() noexcept;
+  ChannelHealth(ChannelHealth &&) = default;
+  ~ChannelHealth() = default;
+
+ public:
+  bool addRead(int32_t error) noexcept;
+  void clearWindow() noexcept;
+  bool isHealthy() const noexcept;
+  int32_t lastError() const noexcept;
+  int32_t statusCode() const noexcept;
+  uint64_t samples() const noexcept;
+  uint64_t failures() const noexcept;
+  float errorRate() const noexcept;
+
+ private:
+  bool m_isHealthy;
+  int32_t m_lastError;
+  uint64_t m_samples;
+  uint64_t m_failures;
+};
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "deadband.hpp"
+
+int64_t const DeadbandFilter::MAX_HEARTBEAT;
+
+DeadbandFilter::DeadbandFilter(float threshold,
+                               int64_t heartbeatInMicroseconds) noexcept
+    : m_threshold{threshold},
+      m_heartbeat{heartbeatInMicroseconds},
+      m_hasPassed{false},
+      m_lastVoltage{0.0f},
+      m_lastTime{0},
+      m_published{0},
+      m_suppressed{0} {}
+
+DeadbandFilter::DeadbandFilter(DeadbandFilter &&other) noexcept
+    : m_threshold{other.m_threshold},
+      m_heartbeat{other.m_heartbeat},
+      m_hasPassed{other.m_hasPassed},
+      m_lastVoltage{other.m_lastVoltage},
+      m_lastTime{other.m_lastTime},
+      m_published{other.m_published.load()},
+      m_suppressed{other.m_suppressed.load()} {}
+
+bool DeadbandFilter::pass(float voltage,
+                          int64_t sampleTimeInMicroseconds) noexcept {
+  float const CHANGE{voltage - m_lastVoltage};
+  bool const PASS{!m_hasPassed || CHANGE > m_threshold ||
+                  CHANGE < -m_threshold ||
+                  (m_heartbeat > 0 &&
+                   sampleTimeInMicroseconds - m_lastTime >= m_heartbeat)};
+  if (PASS) {
+    m_hasPassed = true;
+    m_lastVoltage = voltage;
+    m_lastTime = sampleTimeInMicroseconds;
+    m_published.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    m_suppressed.fetch_add(1, std::memory_order_relaxed);
+  }
+  return PASS;
+}
+
+uint64_t DeadbandFilter::published() const noexcept {
+  return m_published.load(std::memory_order_relaxed);
+}
+
+uint64_t DeadbandFilter::suppressed() const noexcept {
+  return m_suppressed.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEADBAND_HPP
+#define DEADBAND_HPP
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Send-on-change filter for one channel. A sample passes when it differs by
+ * more than the threshold from the last passed sample, or when nothing has
+ * passed for the heartbeat interval so that consumers can detect liveness.
+ * The counters may be read from other threads.
+ */
+class DeadbandFilter {
+ private:
+  DeadbandFilter(DeadbandFilter const &) = delete;
+  DeadbandFilter &operator=(DeadbandFilter const &) = delete;
+  DeadbandFilter &operator=(DeadbandFilter &&) = delete;
+
+ public:
+  // Microseconds; an hour.
+  static int64_t const MAX_HEARTBEAT{3600000000};
+
+ public:
+  DeadbandFilter(float threshold, int64_t heartbeatInMicroseconds) noexcept;
+  DeadbandFilter(DeadbandFilter &&other) noexcept;
+  ~DeadbandFilter() = default;
+
+ public:
+  bool pass(float voltage, int64_t sampleTimeInMicroseconds) noexcept;
+  uint64_t published() const noexcept;
+  uint64_t suppressed() const noexcept;
+
+ private:
+  float m_threshold;
+  int64_t m_heartbeat;
+  bool m_hasPassed;
+  float m_lastVoltage;
+  int64_t m_lastTime;
+  std::atomic<uint64_t> m_published;
+  std::atomic<uint64_t> m_suppressed;
+};
+
+#endif
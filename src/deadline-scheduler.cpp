@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+#include <cmath>
+
+#include "deadline-scheduler.hpp"
+
+int64_t const DeadlineScheduler::MAX_FREQUENCY;
+int64_t const DeadlineScheduler::MAX_PERIOD;
+
+int64_t DeadlineScheduler::periodFromFrequency(float freq) noexcept {
+  double const FREQUENCY{(freq > 0.0f) ? static_cast<double>(freq) : 1.0};
+  // Clamped before rounding, as llround is undefined beyond int64_t.
+  double const PERIOD{1.0e9 / FREQUENCY};
+  int64_t const MIN_PERIOD{1000000000 / MAX_FREQUENCY};
+  if (PERIOD >= static_cast<double>(MAX_PERIOD)) {
+    return MAX_PERIOD;
+  }
+  int64_t const ROUNDED{static_cast<int64_t>(std::llround(PERIOD))};
+  return (ROUNDED < MIN_PERIOD) ? MIN_PERIOD : ROUNDED;
+}
+
+int64_t DeadlineScheduler::now() noexcept {
+  struct timespec ts {};
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+DeadlineScheduler::DeadlineScheduler(int64_t periodInNanoseconds) noexcept
+    : m_period{(periodInNanoseconds > 0) ? periodInNanoseconds : 1},
+      m_start{0},
+      m_index{0},
+      m_ticks{0},
+      m_missedDeadlines{0} {
+  start();
+}
+
+void DeadlineScheduler::start() noexcept {
+  m_start = now();
+  m_index = 1;
+}
+
+void DeadlineScheduler::setPeriod(int64_t periodInNanoseconds) noexcept {
+  // The grid restarts now, so the next deadline is one new period away;
+  // ticks and missed deadlines keep counting.
+  m_period = (periodInNanoseconds > 0) ? periodInNanoseconds : 1;
+  start();
+}
+
+int64_t DeadlineScheduler::nextDeadline() const noexcept {
+  return m_start + static_cast<int64_t>(m_index) * m_period;
+}
+
+int64_t DeadlineScheduler::period() const noexcept {
+  return m_period;
+}
+
+uint64_t DeadlineScheduler::ticks() const noexcept {
+  return m_ticks;
+}
+
+uint64_t DeadlineScheduler::missedDeadlines() const noexcept {
+  return m_missedDeadlines;
+}
+
+bool DeadlineScheduler::waitForNextDeadline() noexcept {
+  skipMissedDeadlines();
+  int64_t const DEADLINE{nextDeadline()};
+  struct timespec ts {};
+  ts.tv_sec = static_cast<time_t>(DEADLINE / 1000000000);
+  ts.tv_nsec = static_cast<long>(DEADLINE % 1000000000);
+  // Interrupted sleeps return false so that the caller can check for
+  // termination; the deadline stays the same for the next attempt.
+  if (0 != ::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr)) {
+    return false;
+  }
+  advance();
+  return true;
+}
+
+void DeadlineScheduler::advance() noexcept {
+  m_ticks++;
+  m_index++;
+}
+
+void DeadlineScheduler::skipMissedDeadlines() noexcept {
+  // A deadline less than one period late is still served right away, which
+  // catches up on the grid; older ones are dropped.
+  int64_t const LATENESS{now() - nextDeadline()};
+  if (LATENESS >= m_period) {
+    uint64_t const MISSED{static_cast<uint64_t>(LATENESS / m_period)};
+    m_missedDeadlines += MISSED;
+    m_index += MISSED;
+  }
+}
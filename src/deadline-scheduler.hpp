@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEADLINE_SCHEDULER_HPP
+#define DEADLINE_SCHEDULER_HPP
+
+#include <time.h>
+
+#include <cstdint>
+
+/**
+ * Periodic scheduler on CLOCK_MONOTONIC with absolute deadlines. Deadline k
+ * is always start + k * period, so the rate does not drift with the time
+ * spent in a tick. A late deadline is served immediately; deadlines that
+ * were overrun by a whole period or more are skipped and counted instead of
+ * being executed back-to-back. periodFromFrequency() rounds to the nearest
+ * nanosecond and keeps the period between those of MAX_FREQUENCY and
+ * MAX_PERIOD.
+ */
+class DeadlineScheduler {
+ private:
+  DeadlineScheduler(DeadlineScheduler const &) = delete;
+  DeadlineScheduler(DeadlineScheduler &&) = delete;
+  DeadlineScheduler &operator=(DeadlineScheduler const &) = delete;
+  DeadlineScheduler &operator=(DeadlineScheduler &&) = delete;
+
+ public:
+  static int64_t const MAX_FREQUENCY{200000};
+  static int64_t const MAX_PERIOD{3600000000000};
+  static int64_t periodFromFrequency(float freq) noexcept;
+  static int64_t now() noexcept;
+
+ public:
+  DeadlineScheduler(int64_t periodInNanoseconds) noexcept;
+  ~DeadlineScheduler() = default;
+
+ public:
+  void start() noexcept;
+  void setPeriod(int64_t periodInNanoseconds) noexcept;
+  bool waitForNextDeadline() noexcept;
+  void advance() noexcept;
+  void skipMissedDeadlines() noexcept;
+  int64_t nextDeadline() const noexcept;
+  int64_t period() const noexcept;
+  uint64_t ticks() const noexcept;
+  uint64_t missedDeadlines() const noexcept;
+
+ private:
+  int64_t m_period;
+  int64_t m_start;
+  uint64_t m_index;
+  uint64_t m_ticks;
+  uint64_t m_missedDeadlines;
+};
+
+#endif
@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "cluon-complete.hpp"
+#include "event-loop.hpp"
+
+EventLoop::EventLoop() noexcept
+    : m_epollFd{::epoll_create1(EPOLL_CLOEXEC)},
+      m_signalFd{-1},
+      m_controlFd{-1},
+      m_controlPath{},
+      m_isStopped{false},
+      m_timers{},
+      m_controlDelegate{},
+      m_delegates{},
+      m_alwaysReady{} {
+  // Make sure the libcluon signal handlers are installed first; blocked
+  // signals are then consumed through the signalfd instead.
+  cluon::TerminateHandler::instance();
+
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  if (0 == ::pthread_sigmask(SIG_BLOCK, &signals, nullptr)) {
+    m_signalFd = ::signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+  }
+  if (m_signalFd >= 0) {
+    add(m_signalFd, [this]() { onSignal(); });
+  }
+}
+
+EventLoop::~EventLoop() noexcept {
+  if (m_controlFd >= 0) {
+    ::close(m_controlFd);
+    ::unlink(m_controlPath.c_str());
+  }
+  for (auto &timer : m_timers) {
+    ::close(timer->fd);
+  }
+  if (m_signalFd >= 0) {
+    ::close(m_signalFd);
+  }
+  if (m_epollFd >= 0) {
+    ::close(m_epollFd);
+  }
+}
+
+bool EventLoop::isValid() const noexcept {
+  return m_epollFd >= 0 && m_signalFd >= 0;
+}
+
+bool EventLoop::add(int32_t fd, std::function<void()> delegate) noexcept {
+  struct epoll_event event {};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  if (0 == ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event)) {
+    m_delegates[fd] = delegate;
+    return true;
+  }
+  // Regular files cannot be polled; they are always ready for reading.
+  if (EPERM == errno) {
+    m_alwaysReady.push_back(delegate);
+    return true;
+  }
+  return false;
+}
+
+bool EventLoop::addTimer(DeadlineScheduler &scheduler,
+                         std::function<void()> delegate) noexcept {
+  std::unique_ptr<Timer> timer{new Timer};
+  timer->fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (timer->fd < 0) {
+    return false;
+  }
+  timer->scheduler = &scheduler;
+  timer->delegate = delegate;
+  Timer *t{timer.get()};
+  m_timers.push_back(std::move(timer));
+  return armTimer(*t) && add(t->fd, [this, t]() { onTimer(*t); });
+}
+
+bool EventLoop::addReader(int32_t fd, std::function<void()> delegate) noexcept {
+  return add(fd, delegate);
+}
+
+bool EventLoop::addControlSocket(
+    std::string const &path,
+    std::function<std::string(std::string const &)> delegate) noexcept {
+  struct sockaddr_un address {};
+  if (m_controlFd >= 0 || path.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  m_controlFd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (m_controlFd < 0) {
+    return false;
+  }
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  ::unlink(path.c_str());
+  if (0 != ::bind(m_controlFd, reinterpret_cast<struct sockaddr *>(&address),
+                  sizeof(address))) {
+    ::close(m_controlFd);
+    m_controlFd = -1;
+    return false;
+  }
+  m_controlPath = path;
+  m_controlDelegate = delegate;
+  return add(m_controlFd, [this]() { onControl(); });
+}
+
+void EventLoop::run(std::function<bool()> isRunning) noexcept {
+  constexpr int32_t MAX_EVENTS{8};
+  struct epoll_event events[MAX_EVENTS];
+  while (!m_isStopped && isRunning()) {
+    int32_t const TIMEOUT{m_alwaysReady.empty() ? -1 : 0};
+    int32_t const N{::epoll_wait(m_epollFd, events, MAX_EVENTS, TIMEOUT)};
+    if (N < 0 && EINTR != errno) {
+      std::cerr << "Failed to wait for events: " << std::strerror(errno)
+                << std::endl;
+      break;
+    }
+    for (int32_t i{0}; i < N && !m_isStopped; i++) {
+      auto delegate = m_delegates.find(events[i].data.fd);
+      if (delegate != m_delegates.end()) {
+        delegate->second();
+      }
+    }
+    for (auto &delegate : m_alwaysReady) {
+      if (!m_isStopped) {
+        delegate();
+      }
+    }
+  }
+}
+
+void EventLoop::stop() noexcept {
+  m_isStopped = true;
+}
+
+bool EventLoop::armTimer(Timer &timer) noexcept {
+  int64_t const DEADLINE{timer.scheduler->nextDeadline()};
+  struct itimerspec spec {};
+  spec.it_value.tv_sec = static_cast<time_t>(DEADLINE / 1000000000);
+  spec.it_value.tv_nsec = static_cast<long>(DEADLINE % 1000000000);
+  return 0 == ::timerfd_settime(timer.fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void EventLoop::onTimer(Timer &timer) noexcept {
+  uint64_t expirations{0};
+  if (sizeof(expirations) !=
+      ::read(timer.fd, &expirations, sizeof(expirations))) {
+    return;
+  }
+  timer.scheduler->advance();
+  timer.delegate();
+  // Re-armed after the tick, so a tick overrunning the next deadline is
+  // counted as missed by the scheduler instead of firing immediately.
+  timer.scheduler->skipMissedDeadlines();
+  armTimer(timer);
+}
+
+void EventLoop::onSignal() noexcept {
+  struct signalfd_siginfo info {};
+  while (sizeof(info) == ::read(m_signalFd, &info, sizeof(info))) {
+    cluon::TerminateHandler::instance().isTerminated.store(true);
+    m_isStopped = true;
+  }
+}
+
+void EventLoop::onControl() noexcept {
+  char buffer[512];
+  struct sockaddr_un from {};
+  socklen_t fromLength{sizeof(from)};
+  ssize_t n;
+  while ((n = ::recvfrom(m_controlFd, buffer, sizeof(buffer) - 1, 0,
+                         reinterpret_cast<struct sockaddr *>(&from),
+                         &fromLength)) >= 0) {
+    std::string command(buffer, static_cast<size_t>(n));
+    while (!command.empty() &&
+           (command.back() == '\n' || command.back() == '\r')) {
+      command.pop_back();
+    }
+    std::string const REPLY{m_controlDelegate(command)};
+    // Only clients that bound an address of their own can get a reply.
+    if (fromLength > sizeof(sa_family_t) && !REPLY.empty()) {
+      ::sendto(m_controlFd, REPLY.data(), REPLY.size(), MSG_DONTWAIT,
+               reinterpret_cast<struct sockaddr *>(&from), fromLength);
+    }
+    fromLength = sizeof(from);
+  }
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENT_LOOP_HPP
+#define EVENT_LOOP_HPP
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "deadline-scheduler.hpp"
+
+/**
+ * Single-threaded epoll loop multiplexing timers (each a timerfd armed on the
+ * absolute deadlines of a DeadlineScheduler), data file descriptors
+ * such as the IIO buffer, a signalfd for SIGINT/SIGTERM, and an optional Unix
+ * datagram control socket.
+ *
+ * The signals are blocked in the constructing thread, so the loop should be
+ * created before any other thread is started. On a signal, the libcluon
+ * TerminateHandler is flagged as well so that isRunning() of sessions agrees.
+ */
+class EventLoop {
+ private:
+  EventLoop(EventLoop const &) = delete;
+  EventLoop(EventLoop &&) = delete;
+  EventLoop &operator=(EventLoop const &) = delete;
+  EventLoop &operator=(EventLoop &&) = delete;
+
+ public:
+  EventLoop() noexcept;
+  ~EventLoop() noexcept;
+
+ public:
+  bool isValid() const noexcept;
+  bool addTimer(DeadlineScheduler &scheduler,
+                std::function<void()> delegate) noexcept;
+  bool addReader(int32_t fd, std::function<void()> delegate) noexcept;
+  bool addControlSocket(
+      std::string const &path,
+      std::function<std::string(std::string const &)> delegate) noexcept;
+  void run(std::function<bool()> isRunning) noexcept;
+  void stop() noexcept;
+
+ private:
+  struct Timer {
+    int32_t fd{-1};
+    DeadlineScheduler *scheduler{nullptr};
+    std::function<void()> delegate{};
+  };
+
+ private:
+  bool add(int32_t fd, std::function<void()> delegate) noexcept;
+  bool armTimer(Timer &timer) noexcept;
+  void onTimer(Timer &timer) noexcept;
+  void onSignal() noexcept;
+  void onControl() noexcept;
+
+ private:
+  int32_t m_epollFd;
+  int32_t m_signalFd;
+  int32_t m_controlFd;
+  std::string m_controlPath;
+  bool m_isStopped;
+  std::vector<std::unique_ptr<Timer>> m_timers;
+  std::function<std::string(std::string const &)> m_controlDelegate;
+  std::map<int32_t, std::function<void()>> m_delegates;
+  std::vector<std::function<void()>> m_alwaysReady;
+};
+
+#endif
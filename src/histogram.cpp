@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+
+#include "histogram.hpp"
+
+uint32_t const LogHistogram::SUB_BUCKET_BITS;
+size_t const LogHistogram::SUB_BUCKETS;
+size_t const LogHistogram::BUCKETS;
+
+size_t LogHistogram::indexOf(uint64_t value) noexcept {
+  if (value < 2 * SUB_BUCKETS) {
+    return static_cast<size_t>(value);
+  }
+  // The top SUB_BUCKET_BITS + 1 bits select the bucket within the octave.
+  uint32_t const EXPONENT{
+      static_cast<uint32_t>(63 - __builtin_clzll(value))};
+  return (EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS +
+         static_cast<size_t>(value >> (EXPONENT - SUB_BUCKET_BITS)) -
+         SUB_BUCKETS;
+}
+
+uint64_t LogHistogram::lowerBound(size_t index) noexcept {
+  if (index < 2 * SUB_BUCKETS) {
+    return index;
+  }
+  uint32_t const SHIFT{
+      static_cast<uint32_t>(index / SUB_BUCKETS - 1)};
+  return static_cast<uint64_t>(index % SUB_BUCKETS + SUB_BUCKETS) << SHIFT;
+}
+
+uint64_t LogHistogram::upperBound(size_t index) noexcept {
+  return (index + 1 < BUCKETS) ? lowerBound(index + 1) - 1 : UINT64_MAX;
+}
+
+LogHistogram::LogHistogram() noexcept
+    : m_buckets{},
+      m_count{0},
+      m_sum{0},
+      m_max{0} {
+  for (auto &bucket : m_buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+void LogHistogram::record(int64_t value) noexcept {
+  uint64_t const VALUE{(value > 0) ? static_cast<uint64_t>(value) : 0};
+  m_buckets[indexOf(VALUE)].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  m_sum.fetch_add(VALUE, std::memory_order_relaxed);
+  uint64_t max{m_max.load(std::memory_order_relaxed)};
+  while (VALUE > max &&
+         !m_max.compare_exchange_weak(max, VALUE, std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t LogHistogram::count() const noexcept {
+  return m_count.load(std::memory_order_relaxed);
+}
+
+uint64_t LogHistogram::sum() const noexcept {
+  return m_sum.load(std::memory_order_relaxed);
+}
+
+uint64_t LogHistogram::max() const noexcept {
+  return m_max.load(std::memory_order_relaxed);
+}
+
+uint64_t LogHistogram::bucket(size_t index) const noexcept {
+  return m_buckets[index].load(std::memory_order_relaxed);
+}
+
+uint64_t LogHistogram::percentile(double fraction) const noexcept {
+  uint64_t total{0};
+  for (size_t i{0}; i < BUCKETS; i++) {
+    total += bucket(i);
+  }
+  uint64_t const RANK{static_cast<uint64_t>(fraction * static_cast<double>(total))};
+  uint64_t seen{0};
+  for (size_t i{0}; i < BUCKETS; i++) {
+    seen += bucket(i);
+    if (seen > RANK) {
+      // Reported as the largest value of the bucket, but never above the
+      // maximum.
+      uint64_t const BOUND{upperBound(i)};
+      return (BOUND < max()) ? BOUND : max();
+    }
+  }
+  return max();
+}
+
+std::string LogHistogram::summary() const noexcept {
+  std::stringstream sstr;
+  uint64_t const COUNT{count()};
+  sstr << "n=" << COUNT << " mean=" << ((COUNT > 0) ? sum() / COUNT : 0)
+       << " p50<=" << percentile(0.5) << " p99<=" << percentile(0.99)
+       << " p999<=" << percentile(0.999) << " max=" << max();
+  return sstr.str();
+}
+
+void LogHistogram::clear() noexcept {
+  for (auto &bucket : m_buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  m_count.store(0, std::memory_order_relaxed);
+  m_sum.store(0, std::memory_order_relaxed);
+  m_max.store(0, std::memory_order_relaxed);
+}
+
+std::string TimingStatistics::summary(uint64_t missedDeadlines) const
+    noexcept {
+  // Alarms are rare, so their latency is only shown once there was one.
+  std::string const ALARM{
+      (alarmLatency.count() > 0)
+          ? "; alarm[ns]: " + alarmLatency.summary()
+          : std::string()};
+  return "period[ns]: " + period.summary() + "; jitter[ns]: " +
+         jitter.summary() + "; read[ns]: " +
+         readLatency.summary() + "; send[ns]: " + sendLatency.summary() +
+         ALARM + "; missed=" + std::to_string(missedDeadlines);
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * Lock-free histogram of non-negative integer values, in whatever unit the
+ * owner states, with log-linear buckets as in HdrHistogram: values below
+ * 64 get a bucket each, and every octave above is split into 32 linear
+ * sub-buckets, so a bucket is at most 1/32 of its values wide. Percentiles
+ * are reported as the largest value of their bucket, but never above the
+ * maximum. Recording is a few relaxed atomic increments, so the sampling
+ * thread can record while another thread reads.
+ */
+class LogHistogram {
+ private:
+  LogHistogram(LogHistogram const &) = delete;
+  LogHistogram(LogHistogram &&) = delete;
+  LogHistogram &operator=(LogHistogram const &) = delete;
+  LogHistogram &operator=(LogHistogram &&) = delete;
+
+ public:
+  static uint32_t const SUB_BUCKET_BITS{5};
+  static size_t const SUB_BUCKETS{size_t{1} << SUB_BUCKET_BITS};
+  static size_t const BUCKETS{(64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS};
+
+ public:
+  static size_t indexOf(uint64_t value) noexcept;
+  static uint64_t lowerBound(size_t index) noexcept;
+  static uint64_t upperBound(size_t index) noexcept;
+
+ public:
+  LogHistogram() noexcept;
+  ~LogHistogram() = default;
+
+ public:
+  void record(int64_t value) noexcept;
+  uint64_t count() const noexcept;
+  uint64_t sum() const noexcept;
+  uint64_t max() const noexcept;
+  uint64_t bucket(size_t index) const noexcept;
+  uint64_t percentile(double fraction) const noexcept;
+  std::string summary() const noexcept;
+  void clear() noexcept;
+
+ private:
+  std::array<std::atomic<uint64_t>, BUCKETS> m_buckets;
+  std::atomic<uint64_t> m_count;
+  std::atomic<uint64_t> m_sum;
+  std::atomic<uint64_t> m_max;
+};
+
+/**
+ * Timing of the acquisition pipeline in nanoseconds: the achieved
+ * tick-to-tick period and its deviation from the nominal period, and the time
+ * spent reading the ADC and sending the readings per tick.
+ */
+struct TimingStatistics {
+  LogHistogram period{};
+  LogHistogram jitter{};
+  LogHistogram readLatency{};
+  LogHistogram sendLatency{};
+  LogHistogram alarmLatency{};
+
+  std::string summary(uint64_t missedDeadlines) const noexcept;
+};
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <sstream>
+
+#include "latency-statistics.hpp"
+
+void LatencyStatistics::Moments::add(int64_t value) noexcept {
+  count++;
+  double const DELTA{static_cast<double>(value) - mean};
+  mean += DELTA / static_cast<double>(count);
+  m2 += DELTA * (static_cast<double>(value) - mean);
+}
+
+double LatencyStatistics::Moments::deviation() const noexcept {
+  return (count < 2) ? 0.0 : std::sqrt(m2 / static_cast<double>(count - 1));
+}
+
+LatencyStatistics::LatencyStatistics() noexcept
+    : m_receivedAge{},
+      m_sentAge{},
+      m_sampleIntervals{},
+      m_arrivalIntervals{},
+      m_shortestSampleInterval{0},
+      m_missingSamples{0},
+      m_negativeAges{0},
+      m_firstReceived{0},
+      m_lastReceived{0},
+      m_lastSampleTime{0},
+      m_hasSample{false},
+      m_lastSequenceNumber{0},
+      m_hasSequenceNumber{false},
+      m_messages{0},
+      m_missingMessages{0},
+      m_reordered{0} {}
+
+void LatencyStatistics::addMessage(int64_t receivedInMicroseconds) noexcept {
+  if (m_messages > 0) {
+    m_arrivalIntervals.add(receivedInMicroseconds - m_lastReceived);
+  } else {
+    m_firstReceived = receivedInMicroseconds;
+  }
+  m_lastReceived = receivedInMicroseconds;
+  m_messages++;
+}
+
+void LatencyStatistics::addSequenceNumber(uint32_t sequenceNumber) noexcept {
+  if (m_hasSequenceNumber) {
+    // Unsigned difference, so that wrap-around is a step of one as well.
+    uint32_t const STEP{sequenceNumber - m_lastSequenceNumber};
+    if (0 == STEP || STEP > 0x80000000u) {
+      m_reordered++;
+      return;
+    }
+    m_missingMessages += STEP - 1;
+  }
+  m_lastSequenceNumber = sequenceNumber;
+  m_hasSequenceNumber = true;
+}
+
+void LatencyStatistics::addSample(int64_t sampleTimeInMicroseconds,
+                                  int64_t sentInMicroseconds,
+                                  int64_t receivedInMicroseconds) noexcept {
+  if (m_hasSample) {
+    int64_t const INTERVAL{sampleTimeInMicroseconds - m_lastSampleTime};
+    m_sampleIntervals.add(INTERVAL);
+    if (INTERVAL > 0) {
+      if (0 == m_shortestSampleInterval || INTERVAL < m_shortestSampleInterval) {
+        m_shortestSampleInterval = INTERVAL;
+      }
+      if (2 * INTERVAL > 3 * m_shortestSampleInterval) {
+        m_missingSamples += static_cast<uint64_t>(
+            std::llround(static_cast<double>(INTERVAL) /
+                         static_cast<double>(m_shortestSampleInterval)) - 1);
+      }
+    }
+  }
+  m_lastSampleTime = sampleTimeInMicroseconds;
+  m_hasSample = true;
+  int64_t const RECEIVED_AGE{receivedInMicroseconds - sampleTimeInMicroseconds};
+  int64_t const SENT_AGE{sentInMicroseconds - sampleTimeInMicroseconds};
+  if (RECEIVED_AGE < 0 || SENT_AGE < 0) {
+    m_negativeAges++;
+  }
+  m_receivedAge.record(RECEIVED_AGE);
+  m_sentAge.record(SENT_AGE);
+}
+
+void LatencyStatistics::clear() noexcept {
+  // The last sample, the shortest interval and the sequence number are kept,
+  // so that gaps across report windows are still counted.
+  m_receivedAge.clear();
+  m_sentAge.clear();
+  m_sampleIntervals = Moments{};
+  m_arrivalIntervals = Moments{};
+  m_missingSamples = 0;
+  m_negativeAges = 0;
+  m_firstReceived = m_lastReceived;
+  m_messages = (m_messages > 0) ? 1 : 0;
+  m_missingMessages = 0;
+  m_reordered = 0;
+}
+
+uint64_t LatencyStatistics::samples() const noexcept {
+  return m_receivedAge.count();
+}
+
+uint64_t LatencyStatistics::missingSamples() const noexcept {
+  return m_missingSamples;
+}
+
+LogHistogram const &LatencyStatistics::receivedAge() const noexcept {
+  return m_receivedAge;
+}
+
+LogHistogram const &LatencyStatistics::sentAge() const noexcept {
+  return m_sentAge;
+}
+
+std::string LatencyStatistics::summary() const noexcept {
+  double const SPAN{static_cast<double>(m_lastReceived - m_firstReceived) *
+                    1.0e-6};
+  std::stringstream sstr;
+  sstr << "samples=" << samples() << " rate="
+       << ((SPAN > 0.0) ? static_cast<double>(samples()) / SPAN : 0.0)
+       << "Hz ";
+  if (m_hasSequenceNumber) {
+    sstr << "missing-messages=" << m_missingMessages
+         << " reordered=" << m_reordered;
+  } else {
+    sstr << "missing-samples=" << m_missingSamples;
+  }
+  if (m_negativeAges > 0) {
+    sstr << " negative-ages=" << m_negativeAges;
+  }
+  sstr << "; age-at-receive[us]: " << m_receivedAge.summary()
+       << "; age-at-send[us]: " << m_sentAge.summary()
+       << "; sample-period[us]: mean=" << m_sampleIntervals.mean
+       << " jitter=" << m_sampleIntervals.deviation()
+       << "; arrival-period[us]: mean=" << m_arrivalIntervals.mean
+       << " jitter=" << m_arrivalIntervals.deviation();
+  return sstr.str();
+}
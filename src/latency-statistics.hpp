@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATENCY_STATISTICS_HPP
+#define LATENCY_STATISTICS_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "histogram.hpp"
+
+/**
+ * End-to-end timing of the readings of one sender as seen by a receiver, in
+ * microseconds: the age of every sample when its message was received and
+ * when it was sent, the intervals between consecutive sample times and
+ * between message arrivals, and gaps. Ages go into log-linear histograms in
+ * microseconds, which resolve a percentile to within 1/32 of its value, and
+ * intervals into running means and deviations, so memory stays fixed
+ * however long a report window is; ages below zero, from clocks that are
+ * not in sync, are counted and taken as 0. Gaps are counted from sequence
+ * numbers where messages carry them, and otherwise from sample intervals
+ * longer than one and a half times the shortest one seen. clear() starts a
+ * new report window.
+ */
+class LatencyStatistics {
+ private:
+  LatencyStatistics(LatencyStatistics const &) = delete;
+  LatencyStatistics(LatencyStatistics &&) = delete;
+  LatencyStatistics &operator=(LatencyStatistics const &) = delete;
+  LatencyStatistics &operator=(LatencyStatistics &&) = delete;
+
+ public:
+  LatencyStatistics() noexcept;
+  ~LatencyStatistics() = default;
+
+ public:
+  void addMessage(int64_t receivedInMicroseconds) noexcept;
+  void addSequenceNumber(uint32_t sequenceNumber) noexcept;
+  void addSample(int64_t sampleTimeInMicroseconds,
+                 int64_t sentInMicroseconds,
+                 int64_t receivedInMicroseconds) noexcept;
+  void clear() noexcept;
+  uint64_t samples() const noexcept;
+  uint64_t missingSamples() const noexcept;
+  LogHistogram const &receivedAge() const noexcept;
+  LogHistogram const &sentAge() const noexcept;
+  std::string summary() const noexcept;
+
+ private:
+  // Running mean and deviation, as Welford's algorithm keeps them.
+  struct Moments {
+    uint64_t count{0};
+    double mean{0.0};
+    double m2{0.0};
+
+    void add(int64_t value) noexcept;
+    double deviation() const noexcept;
+  };
+
+ private:
+  LogHistogram m_receivedAge;
+  LogHistogram m_sentAge;
+  Moments m_sampleIntervals;
+  Moments m_arrivalIntervals;
+  int64_t m_shortestSampleInterval;
+  uint64_t m_missingSamples;
+  uint64_t m_negativeAges;
+  int64_t m_firstReceived;
+  int64_t m_lastReceived;
+  int64_t m_lastSampleTime;
+  bool m_hasSample;
+  uint32_t m_lastSequenceNumber;
+  bool m_hasSequenceNumber;
+  uint64_t m_messages;
+  uint64_t m_missingMessages;
+  uint64_t m_reordered;
+};
+
+#endif
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#include "metrics-server.hpp"
+
+MetricsServer::MetricsServer(std::string const &address, uint16_t port,
+                             std::function<std::string()> delegate) noexcept
+    : m_delegate{delegate},
+      m_listenFd{::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)},
+      m_eventFd{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)},
+      m_isStopped{false},
+      m_thread{} {
+  if (m_listenFd < 0 || m_eventFd < 0) {
+    return;
+  }
+  int32_t const ENABLE{1};
+  ::setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &ENABLE, sizeof(ENABLE));
+  struct sockaddr_in local {};
+  local.sin_family = AF_INET;
+  local.sin_port = htons(port);
+  if (1 != ::inet_pton(AF_INET, address.c_str(), &local.sin_addr) ||
+      0 != ::bind(m_listenFd, reinterpret_cast<struct sockaddr *>(&local),
+                  sizeof(local)) ||
+      0 != ::listen(m_listenFd, 4)) {
+    return;
+  }
+  m_thread = std::thread([this]() { run(); });
+}
+
+MetricsServer::~MetricsServer() noexcept {
+  stop();
+  if (m_eventFd >= 0) {
+    ::close(m_eventFd);
+  }
+  if (m_listenFd >= 0) {
+    ::close(m_listenFd);
+  }
+}
+
+bool MetricsServer::isRunning() const noexcept {
+  return m_thread.joinable();
+}
+
+void MetricsServer::stop() noexcept {
+  if (m_thread.joinable()) {
+    m_isStopped.store(true);
+    uint64_t const ONE{1};
+    ssize_t const WRITTEN{::write(m_eventFd, &ONE, sizeof(ONE))};
+    (void)WRITTEN;
+    m_thread.join();
+  }
+}
+
+void MetricsServer::run() noexcept {
+  struct pollfd events[2] {};
+  events[0].fd = m_listenFd;
+  events[0].events = POLLIN;
+  events[1].fd = m_eventFd;
+  events[1].events = POLLIN;
+  while (!m_isStopped.load()) {
+    if (::poll(events, 2, -1) <= 0 || 0 == (events[0].revents & POLLIN)) {
+      continue;
+    }
+    int32_t const FD{::accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC)};
+    if (FD >= 0) {
+      serve(FD);
+      ::close(FD);
+    }
+  }
+}
+
+void MetricsServer::serve(int32_t fd) noexcept {
+  struct timeval timeout {};
+  timeout.tv_sec = 1;
+  ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  // Only the request line matters; the headers are read up to the blank line
+  // so that closing the socket does not reset the connection.
+  std::string request;
+  char buffer[1024];
+  while (request.find("\r\n\r\n") == std::string::npos &&
+         request.find("\n\n") == std::string::npos && request.size() < 8192) {
+    ssize_t const n{::recv(fd, buffer, sizeof(buffer), 0)};
+    if (n < 0 && EINTR == errno) {
+      continue;
+    }
+    if (n <= 0) {
+      return;
+    }
+    request.append(buffer, static_cast<size_t>(n));
+  }
+
+  std::string const LINE{request.substr(0, request.find_first_of("\r\n"))};
+  bool const IS_METRICS{0 == LINE.find("GET /metrics ") ||
+                        0 == LINE.find("GET / ")};
+  std::string const BODY{IS_METRICS ? m_delegate() : "Not found.\n"};
+  std::string const RESPONSE{
+      std::string(IS_METRICS ? "HTTP/1.0 200 OK\r\n"
+                             : "HTTP/1.0 404 Not Found\r\n") +
+      "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+      "Content-Length: " +
+      std::to_string(BODY.size()) + "\r\nConnection: close\r\n\r\n" + BODY};
+  size_t sent{0};
+  while (sent < RESPONSE.size()) {
+    ssize_t const n{::send(fd, RESPONSE.data() + sent, RESPONSE.size() - sent,
+                           MSG_NOSIGNAL)};
+    if (n < 0 && EINTR == errno) {
+      continue;
+    }
+    if (n <= 0) {
+      return;
+    }
+    sent += static_cast<size_t>(n);
+  }
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef METRICS_SERVER_HPP
+#define METRICS_SERVER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+/**
+ * Minimal HTTP/1.0 responder serving a page of metrics, e.g. for Prometheus
+ * to scrape. One thread of its own blocks in poll() on the listening socket
+ * and answers one connection at a time, so a scrape only costs the sampling
+ * thread the atomic loads done by the page delegate. Requests for anything
+ * but / or /metrics get 404; slow clients are dropped after a second. The
+ * socket is bound to the given IPv4 address, which callers keep at the
+ * loopback address unless the metrics are meant to be reachable remotely.
+ */
+class MetricsServer {
+ private:
+  MetricsServer(MetricsServer const &) = delete;
+  MetricsServer(MetricsServer &&) = delete;
+  MetricsServer &operator=(MetricsServer const &) = delete;
+  MetricsServer &operator=(MetricsServer &&) = delete;
+
+ public:
+  MetricsServer(std::string const &address, uint16_t port,
+                std::function<std::string()> delegate) noexcept;
+  ~MetricsServer() noexcept;
+
+ public:
+  bool isRunning() const noexcept;
+  void stop() noexcept;
+
+ private:
+  void run() noexcept;
+  void serve(int32_t fd) noexcept;
+
+ private:
+  std::function<std::string()> m_delegate;
+  int32_t m_listenFd;
+  int32_t m_eventFd;
+  std::atomic<bool> m_isStopped;
+  std::thread m_thread;
+};
+
+#endif
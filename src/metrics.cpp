@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+#include <cstdio>
+
+#include "metrics.hpp"
+
+size_t const AcquisitionMetrics::CHANNELS;
+
+namespace {
+std::string formatValue(double value) noexcept {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+  return buffer;
+}
+
+void appendHeader(std::string &page, std::string const &name,
+                  std::string const &help, char const *type) noexcept {
+  page += "# HELP " + name + " " + help + "\n# TYPE " + name + " " + type +
+          "\n";
+}
+}
+
+AcquisitionMetrics::AcquisitionMetrics() noexcept
+    : m_channels{},
+      m_ticks{0},
+      m_missedTicks{0},
+      m_period{0},
+      m_sentDatagrams{0},
+      m_sentBytes{0},
+      m_sendErrors{0} {}
+
+void AcquisitionMetrics::addRead(uint8_t channel, int32_t error) noexcept {
+  if (channel >= CHANNELS) {
+    return;
+  }
+  ChannelCounters &counters{m_channels[channel]};
+  if (0 == error) {
+    counters.samples.fetch_add(1, std::memory_order_relaxed);
+  } else if (EBADMSG == error) {
+    counters.parseErrors.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    counters.readFailures.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void AcquisitionMetrics::addSent(int64_t bytes, int32_t error) noexcept {
+  if (0 != error || bytes < 0) {
+    m_sendErrors.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  m_sentDatagrams.fetch_add(1, std::memory_order_relaxed);
+  m_sentBytes.fetch_add(static_cast<uint64_t>(bytes),
+                        std::memory_order_relaxed);
+}
+
+void AcquisitionMetrics::setSchedule(uint64_t ticks, uint64_t missedTicks,
+                                     int64_t period) noexcept {
+  m_ticks.store(ticks, std::memory_order_relaxed);
+  m_missedTicks.store(missedTicks, std::memory_order_relaxed);
+  m_period.store(period, std::memory_order_relaxed);
+}
+
+std::string AcquisitionMetrics::exposition() const noexcept {
+  std::string page;
+  char const *const NAMES[]{"adc_samples_total", "adc_read_failures_total",
+                            "adc_parse_errors_total"};
+  char const *const HELPS[]{
+      "Raw codes read per ADC channel.",
+      "Reads per ADC channel that failed in the kernel or came back empty.",
+      "Reads per ADC channel that did not hold a number."};
+  for (size_t kind{0}; kind < 3; kind++) {
+    appendHeader(page, NAMES[kind], HELPS[kind], "counter");
+    for (size_t channel{0}; channel < CHANNELS; channel++) {
+      ChannelCounters const &counters{m_channels[channel]};
+      uint64_t const SAMPLES{
+          counters.samples.load(std::memory_order_relaxed)};
+      uint64_t const READ_FAILURES{
+          counters.readFailures.load(std::memory_order_relaxed)};
+      uint64_t const PARSE_ERRORS{
+          counters.parseErrors.load(std::memory_order_relaxed)};
+      if (0 == SAMPLES + READ_FAILURES + PARSE_ERRORS) {
+        continue;
+      }
+      uint64_t const VALUE{(0 == kind)   ? SAMPLES
+                           : (1 == kind) ? READ_FAILURES
+                                         : PARSE_ERRORS};
+      page += std::string(NAMES[kind]) + "{channel=\"" +
+              std::to_string(channel) + "\"} " + std::to_string(VALUE) + "\n";
+    }
+  }
+  appendCounter(page, "adc_ticks_total", "Sampling ticks handled.",
+                m_ticks.load(std::memory_order_relaxed));
+  appendCounter(page, "adc_missed_ticks_total",
+                "Sampling ticks skipped as their deadline had passed.",
+                m_missedTicks.load(std::memory_order_relaxed));
+  int64_t const PERIOD{m_period.load(std::memory_order_relaxed)};
+  appendGauge(page, "adc_sampling_frequency_hz",
+              "Current sampling rate of the timer.",
+              (PERIOD > 0) ? 1.0e9 / static_cast<double>(PERIOD) : 0.0);
+  appendCounter(page, "adc_sent_datagrams_total",
+                "Datagrams sent to the OD4 session.",
+                m_sentDatagrams.load(std::memory_order_relaxed));
+  appendCounter(page, "adc_sent_bytes_total",
+                "Bytes sent to the OD4 session.",
+                m_sentBytes.load(std::memory_order_relaxed));
+  appendCounter(page, "adc_send_errors_total",
+                "Datagrams that could not be sent.",
+                m_sendErrors.load(std::memory_order_relaxed));
+  return page;
+}
+
+void appendCounter(std::string &page, std::string const &name,
+                   std::string const &help, uint64_t value) noexcept {
+  appendHeader(page, name, help, "counter");
+  page += name + " " + std::to_string(value) + "\n";
+}
+
+void appendGauge(std::string &page, std::string const &name,
+                 std::string const &help, double value) noexcept {
+  appendHeader(page, name, help, "gauge");
+  page += name + " " + formatValue(value) + "\n";
+}
+
+void appendHistogram(std::string &page, std::string const &name,
+                     std::string const &help,
+                     LogHistogram const &histogram) noexcept {
+  // Four of the 32 sub-buckets per octave, from 1 µs to 8 s, are exposed,
+  // which keeps the page short while resolving a quarter of an octave.
+  uint64_t const FIRST{uint64_t{1} << 10};
+  uint64_t const LAST{uint64_t{1} << 33};
+  size_t const STEP{LogHistogram::SUB_BUCKETS / 4};
+  appendHeader(page, name, help, "histogram");
+  // Buckets are read one by one while the sampling thread may record, so
+  // the total is taken from them to keep +Inf and _count consistent.
+  uint64_t cumulative{0};
+  for (size_t i{0}; i < LogHistogram::BUCKETS; i++) {
+    cumulative += histogram.bucket(i);
+    if (0 == (i + 1) % STEP && i + 1 < LogHistogram::BUCKETS) {
+      uint64_t const BOUND{LogHistogram::lowerBound(i + 1)};
+      if (BOUND >= FIRST && BOUND <= LAST) {
+        page += name + "_bucket{le=\"" +
+                formatValue(static_cast<double>(BOUND) * 1.0e-9) + "\"} " +
+                std::to_string(cumulative) + "\n";
+      }
+    }
+  }
+  page += name + "_bucket{le=\"+Inf\"} " + std::to_string(cumulative) + "\n";
+  page += name + "_sum " +
+          formatValue(static_cast<double>(histogram.sum()) * 1.0e-9) + "\n";
+  page += name + "_count " + std::to_string(cumulative) + "\n";
+}
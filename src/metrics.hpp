@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "histogram.hpp"
+
+/**
+ * Counters of the acquisition, kept as relaxed atomics so that the sampling
+ * thread updates them with a few uncontended increments and a scrape from
+ * another thread never takes a lock the sampling thread could wait on.
+ * Per-channel counters are indexed by ADC channel number, so they survive
+ * runtime reconfiguration.
+ */
+class AcquisitionMetrics {
+ private:
+  AcquisitionMetrics(AcquisitionMetrics const &) = delete;
+  AcquisitionMetrics(AcquisitionMetrics &&) = delete;
+  AcquisitionMetrics &operator=(AcquisitionMetrics const &) = delete;
+  AcquisitionMetrics &operator=(AcquisitionMetrics &&) = delete;
+
+ public:
+  static size_t const CHANNELS{8};
+
+ public:
+  AcquisitionMetrics() noexcept;
+  ~AcquisitionMetrics() = default;
+
+ public:
+  void addRead(uint8_t channel, int32_t error) noexcept;
+  void addSent(int64_t bytes, int32_t error) noexcept;
+  void setSchedule(uint64_t ticks, uint64_t missedTicks,
+                   int64_t period) noexcept;
+  std::string exposition() const noexcept;
+
+ private:
+  struct ChannelCounters {
+    std::atomic<uint64_t> samples{0};
+    std::atomic<uint64_t> readFailures{0};
+    std::atomic<uint64_t> parseErrors{0};
+  };
+
+ private:
+  std::array<ChannelCounters, CHANNELS> m_channels;
+  std::atomic<uint64_t> m_ticks;
+  std::atomic<uint64_t> m_missedTicks;
+  std::atomic<int64_t> m_period;
+  std::atomic<uint64_t> m_sentDatagrams;
+  std::atomic<uint64_t> m_sentBytes;
+  std::atomic<uint64_t> m_sendErrors;
+};
+
+/**
+ * Writers of the Prometheus text exposition format, version 0.0.4.
+ * Durations of a LogHistogram, recorded in nanoseconds, are exposed in
+ * seconds, with four bucket bounds per octave from 1 µs to 8 s and the rest
+ * in +Inf.
+ */
+void appendCounter(std::string &page, std::string const &name,
+                   std::string const &help, uint64_t value) noexcept;
+void appendGauge(std::string &page, std::string const &name,
+                 std::string const &help, double value) noexcept;
+void appendHistogram(std::string &page, std::string const &name,
+                     std::string const &help,
+                     LogHistogram const &histogram) noexcept;
+
+#endif
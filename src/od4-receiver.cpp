@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+
+#include "od4-receiver.hpp"
+
+namespace {
+// Reads the dataType from the first field of a serialized envelope, which
+// follows the 5-byte OD4 header as field 1 with a zig-zag varint.
+bool peekDataType(char const *data, size_t size, int32_t &dataType) noexcept {
+  size_t i{5};
+  if (size <= i + 1 || 0x08 != static_cast<uint8_t>(data[i])) {
+    return false;
+  }
+  i++;
+  uint64_t value{0};
+  for (uint32_t shift{0}; i < size && shift < 64; shift += 7, i++) {
+    uint8_t const BYTE{static_cast<uint8_t>(data[i])};
+    value |= static_cast<uint64_t>(BYTE & 0x7f) << shift;
+    if (0 == (BYTE & 0x80)) {
+      dataType = static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+Od4Receiver::Od4Receiver(uint16_t cid, uint16_t ownSendFromPort) noexcept
+    : m_fd{::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)},
+      m_ownSendFromPort{ownSendFromPort},
+      m_localAddresses{},
+      m_buffer(65536),
+      m_delegates{} {
+  if (m_fd < 0) {
+    return;
+  }
+  std::string const GROUP{"225.0.0." + std::to_string(cid)};
+  int32_t const YES{1};
+  struct sockaddr_in address {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(12175);
+  // Bound to the group rather than to any address, so that other sessions
+  // on the same port are not received as well.
+  address.sin_addr.s_addr = ::inet_addr(GROUP.c_str());
+  struct ip_mreq membership {};
+  membership.imr_multiaddr.s_addr = ::inet_addr(GROUP.c_str());
+  membership.imr_interface.s_addr = htonl(INADDR_ANY);
+  if (0 != ::setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &YES, sizeof(YES)) ||
+      0 != ::bind(m_fd, reinterpret_cast<struct sockaddr *>(&address),
+                  sizeof(address)) ||
+      0 != ::setsockopt(m_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership,
+                        sizeof(membership))) {
+    ::close(m_fd);
+    m_fd = -1;
+    return;
+  }
+  struct ifaddrs *interfaceAddresses{nullptr};
+  if (0 == ::getifaddrs(&interfaceAddresses)) {
+    for (struct ifaddrs *it{interfaceAddresses}; nullptr != it;
+         it = it->ifa_next) {
+      if (nullptr != it->ifa_addr && AF_INET == it->ifa_addr->sa_family) {
+        m_localAddresses.insert(
+            reinterpret_cast<struct sockaddr_in *>(it->ifa_addr)
+                ->sin_addr.s_addr);
+      }
+    }
+    ::freeifaddrs(interfaceAddresses);
+  }
+}
+
+Od4Receiver::~Od4Receiver() noexcept {
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+}
+
+bool Od4Receiver::isOpen() const noexcept {
+  return m_fd >= 0;
+}
+
+int32_t Od4Receiver::fd() const noexcept {
+  return m_fd;
+}
+
+void Od4Receiver::dataTrigger(
+    int32_t dataType,
+    std::function<void(cluon::data::Envelope &&envelope)> delegate) noexcept {
+  m_delegates[dataType] = delegate;
+}
+
+void Od4Receiver::receive() noexcept {
+  struct sockaddr_in from {};
+  socklen_t fromLength{sizeof(from)};
+  ssize_t n;
+  while ((n = ::recvfrom(m_fd, m_buffer.data(), m_buffer.size(), 0,
+                         reinterpret_cast<struct sockaddr *>(&from),
+                         &fromLength)) >= 0) {
+    size_t const SIZE{static_cast<size_t>(n)};
+    fromLength = sizeof(from);
+    int32_t dataType{0};
+    bool const IS_OWN{ntohs(from.sin_port) == m_ownSendFromPort &&
+                      m_localAddresses.count(from.sin_addr.s_addr) != 0};
+    if (IS_OWN || !peekDataType(m_buffer.data(), SIZE, dataType)) {
+      continue;
+    }
+    auto delegate = m_delegates.find(dataType);
+    if (delegate == m_delegates.end()) {
+      continue;
+    }
+    std::stringstream sstr(std::string(m_buffer.data(), SIZE));
+    auto envelope = cluon::extractEnvelope(sstr);
+    if (envelope.first) {
+      envelope.second.received(cluon::time::now());
+      delegate->second(std::move(envelope.second));
+    }
+  }
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OD4_RECEIVER_HPP
+#define OD4_RECEIVER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "cluon-complete.hpp"
+
+/**
+ * Receiving half of an OD4 session without threads of its own: a
+ * non-blocking socket in the session's multicast group, to be read from an
+ * EventLoop. As with OD4Session::dataTrigger, envelopes are only handed to
+ * the delegate registered for their dataType. The dataType is peeked at
+ * before the envelope is decoded, so the session's other traffic costs
+ * little more than the read. As in cluon::UDPReceiver, datagrams from the
+ * given port on one of this host's addresses (our own sender) are skipped
+ * entirely; the same port on another host is a different sender.
+ */
+class Od4Receiver {
+ private:
+  Od4Receiver(Od4Receiver const &) = delete;
+  Od4Receiver(Od4Receiver &&) = delete;
+  Od4Receiver &operator=(Od4Receiver const &) = delete;
+  Od4Receiver &operator=(Od4Receiver &&) = delete;
+
+ public:
+  Od4Receiver(uint16_t cid, uint16_t ownSendFromPort) noexcept;
+  ~Od4Receiver() noexcept;
+
+ public:
+  bool isOpen() const noexcept;
+  int32_t fd() const noexcept;
+  void dataTrigger(
+      int32_t dataType,
+      std::function<void(cluon::data::Envelope &&envelope)> delegate) noexcept;
+  void receive() noexcept;
+
+ private:
+  int32_t m_fd;
+  uint16_t m_ownSendFromPort;
+  std::set<uint32_t> m_localAddresses;
+  std::vector<char> m_buffer;
+  std::map<int32_t, std::function<void(cluon::data::Envelope &&)>> m_delegates;
+};
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "od4-sender.hpp"
+
+Od4Sender::Od4Sender(uint16_t cid) noexcept
+    : m_sender{"225.0.0." + std::to_string(cid), 12175} {
+  // Installs the signal handlers that isRunning() depends on.
+  cluon::TerminateHandler::instance();
+}
+
+void Od4Sender::send(cluon::data::Envelope &&envelope) noexcept {
+  m_sender.send(cluon::serializeEnvelope(std::move(envelope)));
+}
+
+bool Od4Sender::isRunning() const noexcept {
+  // The sender binds a port of its own only if its socket could be set up.
+  return 0 != m_sender.getSendFromPort() &&
+         !cluon::TerminateHandler::instance().isTerminated.load();
+}
+
+cluon::UDPSender &Od4Sender::sender() noexcept {
+  return m_sender;
+}
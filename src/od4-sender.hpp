@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OD4_SENDER_HPP
+#define OD4_SENDER_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "cluon-complete.hpp"
+
+/**
+ * Publish-only counterpart of cluon::OD4Session. The session's UDPReceiver
+ * joins the multicast group and starts a reader and a pipeline thread even
+ * when nothing is ever received; this only holds the sender. Envelopes are
+ * serialized exactly as OD4Session::send does, and isRunning() follows the
+ * libcluon TerminateHandler as the session's does.
+ */
+class Od4Sender {
+ private:
+  Od4Sender(Od4Sender const &) = delete;
+  Od4Sender(Od4Sender &&) = delete;
+  Od4Sender &operator=(Od4Sender const &) = delete;
+  Od4Sender &operator=(Od4Sender &&) = delete;
+
+ public:
+  explicit Od4Sender(uint16_t cid) noexcept;
+  ~Od4Sender() = default;
+
+ public:
+  // Serialized as OD4Session::send does, including that an unset sample
+  // time stamp is replaced by the sent time stamp.
+  template <typename T>
+  static std::string serialize(T &message,
+                               cluon::data::TimeStamp const &sampleTimeStamp,
+                               uint32_t senderStamp) noexcept {
+    cluon::ToProtoVisitor protoEncoder;
+    message.accept(protoEncoder);
+    cluon::data::Envelope envelope;
+    envelope.dataType(static_cast<int32_t>(message.ID()));
+    envelope.serializedData(protoEncoder.encodedData());
+    cluon::data::TimeStamp const SENT{cluon::time::now()};
+    envelope.sent(SENT);
+    envelope.sampleTimeStamp(
+        (0 == (sampleTimeStamp.seconds() + sampleTimeStamp.microseconds()))
+            ? SENT
+            : sampleTimeStamp);
+    envelope.senderStamp(senderStamp);
+    return cluon::serializeEnvelope(std::move(envelope));
+  }
+
+  template <typename T>
+  void send(T &message,
+            cluon::data::TimeStamp const &sampleTimeStamp = cluon::data::TimeStamp{},
+            uint32_t senderStamp = 0) noexcept {
+    m_sender.send(serialize(message, sampleTimeStamp, senderStamp));
+  }
+  void send(cluon::data::Envelope &&envelope) noexcept;
+  bool isRunning() const noexcept;
+  cluon::UDPSender &sender() noexcept;
+
+ private:
+  cluon::UDPSender m_sender;
+};
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "adc-sampler.hpp"
+#include "cluon-complete.hpp"
+#include "opendlv-device-adc-bbblue-message-set.hpp"
+#include "opendlv-standard-message-set.hpp"
+#include "raw-archive.hpp"
+#include "voltage-envelope-encoder.hpp"
+
+int32_t main(int32_t argc, char **argv) {
+  int32_t retCode{0};
+  auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
+  if (0 == commandlineArguments.count("archive")) {
+    std::cerr << argv[0]
+              << " decodes a raw-sample archive written by "
+                 "opendlv-device-adc-bbblue --archive to stdout."
+              << std::endl;
+    std::cerr << "Usage:   " << argv[0]
+              << " --archive=<archive file> [--csv]" << std::endl;
+    std::cerr << "         Without --csv, opendlv.proxy.VoltageReading "
+                 "envelopes are written in .rec format, with the sample time "
+                 "as sent and sample time stamps, along with the archived "
+                 "opendlv.device.adc.VoltageAlarm envelopes. With --csv, "
+                 "only the samples are written."
+              << std::endl;
+    std::cerr << "Example: " << argv[0]
+              << " --archive=/data/adc-0.adca > adc.rec" << std::endl;
+    std::cerr << "         " << argv[0]
+              << " --archive=/data/adc-0.adca --csv > adc.csv" << std::endl;
+    retCode = 1;
+  } else {
+    bool const CSV{commandlineArguments.count("csv") != 0};
+    std::ifstream in(commandlineArguments["archive"], std::ios::binary);
+    if (!in.is_open()) {
+      std::cerr << "Failed to open " << commandlineArguments["archive"] << "."
+                << std::endl;
+      return 1;
+    }
+
+    VoltageEnvelopeEncoder voltageEncoder{
+        opendlv::proxy::VoltageReading::ID()};
+    std::FILE *out{stdout};
+    if (CSV) {
+      std::fputs("channel,senderStamp,sampleTimeStamp,raw,voltage\n", out);
+    }
+    ArchiveDecoder decoder{in};
+    uint64_t samples{0};
+    while (decoder.next()) {
+      if (decoder.isAlarm()) {
+        ArchiveAlarm const &ALARM{decoder.alarm()};
+        if (!CSV) {
+          opendlv::device::adc::VoltageAlarm voltageAlarm;
+          voltageAlarm.channel(ALARM.channel);
+          voltageAlarm.isActive(ALARM.isActive);
+          voltageAlarm.voltage(ALARM.voltage);
+          voltageAlarm.threshold(ALARM.threshold);
+          voltageAlarm.release(ALARM.release);
+          voltageAlarm.since(ALARM.since);
+          cluon::ToProtoVisitor protoEncoder;
+          voltageAlarm.accept(protoEncoder);
+          cluon::data::TimeStamp const TIME{
+              cluon::time::fromMicroseconds(ALARM.timeStamp)};
+          cluon::data::Envelope envelope;
+          envelope.dataType(opendlv::device::adc::VoltageAlarm::ID());
+          envelope.serializedData(protoEncoder.encodedData());
+          envelope.sent(TIME);
+          envelope.sampleTimeStamp(TIME);
+          envelope.senderStamp(ALARM.senderStamp);
+          std::string const DATA{cluon::serializeEnvelope(std::move(envelope))};
+          std::fwrite(DATA.data(), 1, DATA.size(), out);
+        }
+        continue;
+      }
+      ArchiveBlockHeader const &HEADER{decoder.header()};
+      AdcChannelConfig const CONFIG{toChannelConfig(HEADER)};
+      std::vector<int32_t> const &RAW{decoder.raw()};
+      for (size_t i{0}; i < RAW.size(); i++) {
+        int64_t const SAMPLE_TIME{
+            HEADER.baseTimeStamp +
+            static_cast<int64_t>(i) * HEADER.samplePeriod / 1000};
+        float const VOLTAGE{toVoltage(CONFIG, RAW[i])};
+        if (CSV) {
+          std::fprintf(out, "%u,%u,%lld,%d,%.4f\n", +HEADER.channel,
+                       HEADER.senderStamp,
+                       static_cast<long long>(SAMPLE_TIME), RAW[i],
+                       static_cast<double>(VOLTAGE));
+        } else {
+          cluon::data::TimeStamp const TIME{
+              cluon::time::fromMicroseconds(SAMPLE_TIME)};
+          char buffer[VoltageEnvelopeEncoder::MAX_SIZE];
+          size_t const SIZE{voltageEncoder.encode(
+              buffer, VOLTAGE, TIME.seconds(), TIME.microseconds(),
+              TIME.seconds(), TIME.microseconds(), HEADER.senderStamp)};
+          std::fwrite(buffer, 1, SIZE, out);
+        }
+      }
+      samples += RAW.size();
+    }
+    std::fflush(out);
+    if (decoder.isCorrupt()) {
+      std::cerr << "Stopped at a corrupt or truncated block after " << samples
+                << " samples." << std::endl;
+      retCode = 1;
+    }
+  }
+  return retCode;
+}
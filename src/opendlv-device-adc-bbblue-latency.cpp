@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "cluon-complete.hpp"
+#include "latency-statistics.hpp"
+#include "opendlv-device-adc-bbblue-message-set.hpp"
+#include "opendlv-standard-message-set.hpp"
+
+int32_t main(int32_t argc, char **argv) {
+  int32_t retCode{0};
+  auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
+  if (0 == commandlineArguments.count("cid")) {
+    std::cerr << argv[0]
+              << " measures how old the voltages of opendlv-device-adc-bbblue "
+                 "are when they are sent and received."
+              << std::endl;
+    std::cerr << "Usage:   " << argv[0]
+              << " --cid=<OpenDaVINCI session> [--report=<seconds per report "
+                 "window; otherwise one report at exit>] [--duration=<seconds "
+                 "to measure>]"
+              << std::endl;
+    std::cerr << "         opendlv.proxy.VoltageReading and "
+                 "opendlv.device.adc.VoltageReadingBatch messages are "
+                 "reported per senderStamp; every sample of a batch counts. "
+                 "Sender and receiver clocks must be synchronized, or be the "
+                 "same host."
+              << std::endl;
+    std::cerr << "Example: " << argv[0] << " --cid=111 --report=10"
+              << std::endl;
+    std::cerr << "         opendlv-device-adc-bbblue-simulator "
+                 "--iio-root=/tmp/adc --channel=6 --freq=1000 & "
+                 "opendlv-device-adc-bbblue --cid=111 --freq=100 --channel=6 "
+                 "--iio-root=/tmp/adc & "
+              << argv[0] << " --cid=111 --duration=30" << std::endl;
+    retCode = 1;
+  } else {
+    uint16_t const CID = std::stoi(commandlineArguments["cid"]);
+    int64_t const REPORT{(commandlineArguments["report"].size() != 0)
+                             ? static_cast<int64_t>(
+                                   std::stod(commandlineArguments["report"]) *
+                                   1000.0)
+                             : 0};
+    int64_t const DURATION{(commandlineArguments["duration"].size() != 0)
+                               ? static_cast<int64_t>(
+                                     std::stod(commandlineArguments["duration"]) *
+                                     1000.0)
+                               : 0};
+
+    std::mutex statisticsMutex;
+    std::map<uint32_t, LatencyStatistics> statistics;
+    auto onEnvelope{[&statisticsMutex, &statistics](
+                        cluon::data::Envelope &&envelope) {
+      int64_t const RECEIVED{cluon::time::toMicroseconds(envelope.received())};
+      int64_t const SENT{cluon::time::toMicroseconds(envelope.sent())};
+      int64_t const SAMPLE_TIME{
+          cluon::time::toMicroseconds(envelope.sampleTimeStamp())};
+      if (opendlv::proxy::VoltageReading::ID() == envelope.dataType()) {
+        std::lock_guard<std::mutex> lock(statisticsMutex);
+        LatencyStatistics &sender{statistics[envelope.senderStamp()]};
+        sender.addMessage(RECEIVED);
+        sender.addSample(SAMPLE_TIME, SENT, RECEIVED);
+      } else if (opendlv::device::adc::VoltageReadingBatch::ID() ==
+                 envelope.dataType()) {
+        uint32_t const SENDER_STAMP{envelope.senderStamp()};
+        auto batch = cluon::extractMessage<
+            opendlv::device::adc::VoltageReadingBatch>(std::move(envelope));
+        size_t const COUNT{batch.samples().size() / sizeof(float)};
+        std::lock_guard<std::mutex> lock(statisticsMutex);
+        LatencyStatistics &sender{statistics[SENDER_STAMP]};
+        sender.addMessage(RECEIVED);
+        sender.addSequenceNumber(batch.sequenceNumber());
+        for (size_t i{0}; i < COUNT; i++) {
+          int64_t const TIME{
+              batch.baseTimeStamp() +
+              static_cast<int64_t>(i) *
+                  static_cast<int64_t>(batch.samplePeriod()) / 1000};
+          sender.addSample(TIME, SENT, RECEIVED);
+        }
+      }
+    }};
+
+    auto report{[&statisticsMutex, &statistics]() {
+      std::lock_guard<std::mutex> lock(statisticsMutex);
+      for (auto &sender : statistics) {
+        std::cout << "sender " << sender.first << ": "
+                  << sender.second.summary() << std::endl;
+        sender.second.clear();
+      }
+    }};
+
+    cluon::OD4Session od4{CID, onEnvelope};
+    auto const START{std::chrono::steady_clock::now()};
+    auto lastReport{START};
+    while (od4.isRunning()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      auto const NOW{std::chrono::steady_clock::now()};
+      if (DURATION > 0 &&
+          std::chrono::duration_cast<std::chrono::milliseconds>(NOW - START)
+                  .count() >= DURATION) {
+        break;
+      }
+      if (REPORT > 0 &&
+          std::chrono::duration_cast<std::chrono::milliseconds>(NOW -
+                                                                lastReport)
+                  .count() >= REPORT) {
+        report();
+        lastReport = NOW;
+      }
+    }
+    report();
+  }
+  return retCode;
+}
@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "adc-sampler.hpp"
+#include "cluon-complete.hpp"
+#include "deadline-scheduler.hpp"
+#include "waveform.hpp"
+
+namespace {
+bool makeDirectories(std::string const &path) noexcept {
+  for (size_t i{1}; i <= path.size(); i++) {
+    if (i == path.size() || '/' == path[i]) {
+      std::string const PARENT{path.substr(0, i)};
+      if (0 != ::mkdir(PARENT.c_str(), 0755) && EEXIST != errno) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool writeFile(std::string const &path, std::string const &value) noexcept {
+  std::ofstream file(path);
+  file << value << std::endl;
+  return file.good();
+}
+}  // namespace
+
+int32_t main(int32_t argc, char **argv) {
+  int32_t retCode{0};
+  auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
+  if (0 == commandlineArguments.count("channel") ||
+      (0 == commandlineArguments.count("iio-root") &&
+       0 == commandlineArguments.count("fifo"))) {
+    std::cerr << argv[0]
+              << " simulates the analog-to-digital converters of the "
+                 "BeagleBone Blue for opendlv-device-adc-bbblue."
+              << std::endl;
+    std::cerr << "Usage:   " << argv[0]
+              << " --channel=<the ADC channel(s) to simulate, "
+                 "comma-separated> [--iio-root=<directory to fill with "
+                 "in_voltageN_raw files, scan_elements/ and buffer/>] "
+                 "[--fifo=<FIFO to serve scans into in the buffered-device "
+                 "format, le:u12/16>>0 in ascending channel order>] "
+                 "[--freq=<updates or scans per second, default 100>] "
+                 "[--conversion=<Factor from full scale to volts; one per "
+                 "channel, or one for all>] [--wave=<<channel>:<shape>:"
+                 "<parameters>, comma-separated>] [--stuck=<<channel>:<at "
+                 "s>[:<code>], comma-separated>] [--seed=<of the noise, "
+                 "default 1>] [--duration=<seconds to run>] [--verbose]"
+              << std::endl;
+    std::cerr << "         Shapes, in volts and seconds: constant:<V>, "
+                 "sine:<mean>:<amplitude>:<Hz>, step:<before>:<after>:<at>, "
+                 "noise:<mean>:<deviation>, sag:<nominal>:<sagged>:<start>:"
+                 "<duration>[:<period>]. Channels without a wave read 0."
+              << std::endl;
+    std::cerr << "Example: " << argv[0]
+              << " --iio-root=/tmp/adc --channel=6 --freq=100 "
+                 "--wave=6:sag:12:9:2:0.5:5"
+              << std::endl;
+    std::cerr << "         " << argv[0]
+              << " --iio-root=/tmp/adc --fifo=/tmp/adc.fifo --channel=5,6 "
+                 "--freq=1000 --wave=5:sine:12:1:2,6:noise:12:0.1 "
+                 "--stuck=5:10"
+              << std::endl;
+    retCode = 1;
+  } else {
+    bool const VERBOSE{commandlineArguments.count("verbose") != 0};
+    std::string const IIO_ROOT{commandlineArguments["iio-root"]};
+    std::string const FIFO{commandlineArguments["fifo"]};
+    float const FREQ{(commandlineArguments["freq"].size() != 0)
+                         ? std::stof(commandlineArguments["freq"])
+                         : 100.0f};
+    if (!(FREQ > 0.0f) || FREQ > DeadlineScheduler::MAX_FREQUENCY) {
+      std::cerr << "Not supported frequency, must be above 0 and at most "
+                << DeadlineScheduler::MAX_FREQUENCY << " Hz." << std::endl;
+      return 1;
+    }
+    uint32_t const SEED{(commandlineArguments["seed"].size() != 0)
+                            ? static_cast<uint32_t>(
+                                  std::stoul(commandlineArguments["seed"]))
+                            : 1u};
+    int64_t const DURATION{
+        (commandlineArguments["duration"].size() != 0)
+            ? static_cast<int64_t>(
+                  std::stod(commandlineArguments["duration"]) * 1.0e9)
+            : 0};
+
+    std::vector<AdcChannelConfig> configs;
+    std::vector<WaveformSpec> specs;
+    try {
+      configs = parseChannelConfigs(commandlineArguments["channel"], "",
+                                    commandlineArguments["conversion"]);
+      specs = parseWaveforms(commandlineArguments["wave"],
+                             commandlineArguments["stuck"]);
+    } catch (std::exception const &e) {
+      std::cerr << "Invalid simulation: " << e.what() << std::endl;
+      return 1;
+    }
+    // Scans are packed in ascending channel order, as the scan index of a
+    // channel is its number.
+    std::sort(configs.begin(), configs.end(),
+              [](AdcChannelConfig const &a, AdcChannelConfig const &b) {
+                return a.channel < b.channel;
+              });
+    std::vector<Waveform> waveforms;
+    for (AdcChannelConfig const &config : configs) {
+      WaveformSpec spec;
+      spec.channel = config.channel;
+      spec.parameters.push_back(0.0);
+      for (WaveformSpec const &s : specs) {
+        if (s.channel == config.channel) {
+          spec = s;
+        }
+      }
+      waveforms.emplace_back(spec, config, SEED);
+    }
+    for (WaveformSpec const &spec : specs) {
+      if (waveforms.end() ==
+          std::find_if(waveforms.begin(), waveforms.end(),
+                       [&spec](Waveform const &w) {
+                         return w.channel() == spec.channel;
+                       })) {
+        std::cerr << "Waveform for channel " << +spec.channel
+                  << " which is not simulated." << std::endl;
+        return 1;
+      }
+    }
+
+    std::vector<int32_t> rawFds;
+    if (!IIO_ROOT.empty()) {
+      if (!makeDirectories(IIO_ROOT + "/scan_elements") ||
+          !makeDirectories(IIO_ROOT + "/buffer")) {
+        std::cerr << "Failed to create " << IIO_ROOT << ": "
+                  << std::strerror(errno) << std::endl;
+        return 1;
+      }
+      writeFile(IIO_ROOT + "/buffer/length", "1024");
+      writeFile(IIO_ROOT + "/buffer/enable", "0");
+      for (AdcChannelConfig const &config : configs) {
+        std::string const NAME{"in_voltage" + std::to_string(config.channel)};
+        writeFile(IIO_ROOT + "/scan_elements/" + NAME + "_en", "0");
+        writeFile(IIO_ROOT + "/scan_elements/" + NAME + "_index",
+                  std::to_string(config.channel));
+        writeFile(IIO_ROOT + "/scan_elements/" + NAME + "_type",
+                  "le:u12/16>>0");
+        // Kept open and overwritten in place at a fixed width, so that a
+        // reader holding the file open never sees it truncated.
+        std::string const PATH{IIO_ROOT + "/" + NAME + "_raw"};
+        int32_t const FD{
+            ::open(PATH.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)};
+        if (FD < 0) {
+          std::cerr << "Failed to open " << PATH << ": "
+                    << std::strerror(errno) << std::endl;
+          return 1;
+        }
+        rawFds.push_back(FD);
+      }
+    }
+
+    if (!FIFO.empty()) {
+      struct stat status;
+      if (0 != ::mkfifo(FIFO.c_str(), 0644) && EEXIST != errno) {
+        std::cerr << "Failed to create " << FIFO << ": "
+                  << std::strerror(errno) << std::endl;
+        return 1;
+      }
+      if (0 != ::stat(FIFO.c_str(), &status) || !S_ISFIFO(status.st_mode)) {
+        std::cerr << FIFO << " exists and is not a FIFO." << std::endl;
+        return 1;
+      }
+      // A reader that went away is noticed through EPIPE instead.
+      ::signal(SIGPIPE, SIG_IGN);
+    }
+
+    auto &terminateHandler = cluon::TerminateHandler::instance();
+    int64_t const PERIOD{DeadlineScheduler::periodFromFrequency(FREQ)};
+    // Scans into the FIFO are generated on the sample grid but written at
+    // most every millisecond, in atomic chunks of whole scans.
+    int64_t const TICK_PERIOD{FIFO.empty() ? PERIOD
+                                           : std::max<int64_t>(PERIOD, 1000000)};
+    size_t const SCAN_SIZE{2 * configs.size()};
+    size_t const SCANS_PER_WRITE{std::max<size_t>(PIPE_BUF / SCAN_SIZE, 1)};
+    std::vector<uint8_t> scans(SCANS_PER_WRITE * SCAN_SIZE);
+    int32_t fifoFd{-1};
+    uint64_t samples{0};
+    uint64_t droppedScans{0};
+    uint64_t writeErrors{0};
+
+    DeadlineScheduler scheduler{TICK_PERIOD};
+    int64_t const START{DeadlineScheduler::now()};
+    while (!terminateHandler.isTerminated.load()) {
+      if (!scheduler.waitForNextDeadline()) {
+        continue;
+      }
+      int64_t const ELAPSED{DeadlineScheduler::now() - START};
+      if (DURATION > 0 && ELAPSED >= DURATION) {
+        break;
+      }
+      if (!FIFO.empty() && fifoFd < 0) {
+        // Non-blocking, as opening for writing fails while nobody reads.
+        fifoFd = ::open(FIFO.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fifoFd >= 0 && VERBOSE) {
+          std::cerr << "Serving scans into " << FIFO << "." << std::endl;
+        }
+      }
+
+      uint64_t const DUE{static_cast<uint64_t>(ELAPSED / PERIOD)};
+      if (FIFO.empty()) {
+        int64_t const T{ELAPSED / 1000};
+        for (size_t i{0}; i < waveforms.size(); i++) {
+          int32_t const RAW{waveforms[i].raw(T)};
+          if (i < rawFds.size()) {
+            char buffer[8];
+            int32_t const LENGTH{
+                std::snprintf(buffer, sizeof(buffer), "%04d\n", RAW)};
+            if (LENGTH != ::pwrite(rawFds[i], buffer,
+                                   static_cast<size_t>(LENGTH), 0)) {
+              writeErrors++;
+            }
+          }
+          if (VERBOSE) {
+            std::cout << "Channel " << +waveforms[i].channel() << " at "
+                      << T << " us: " << RAW << std::endl;
+          }
+        }
+        samples = DUE;
+      } else {
+        while (samples < DUE) {
+          size_t const N{static_cast<size_t>(
+              std::min<uint64_t>(DUE - samples, SCANS_PER_WRITE))};
+          for (size_t n{0}; n < N; n++) {
+            int64_t const T{
+                static_cast<int64_t>(samples + n) * PERIOD / 1000};
+            for (size_t i{0}; i < waveforms.size(); i++) {
+              uint16_t const RAW{static_cast<uint16_t>(waveforms[i].raw(T))};
+              scans[n * SCAN_SIZE + 2 * i] = static_cast<uint8_t>(RAW & 0xff);
+              scans[n * SCAN_SIZE + 2 * i + 1] = static_cast<uint8_t>(RAW >> 8);
+            }
+          }
+          samples += N;
+          if (fifoFd < 0) {
+            droppedScans += N;
+            continue;
+          }
+          // Like the kernel buffer, scans the reader has no room for are
+          // lost rather than delaying the signal.
+          ssize_t const WRITTEN{::write(fifoFd, scans.data(), N * SCAN_SIZE)};
+          if (WRITTEN < 0) {
+            droppedScans += N;
+            if (EAGAIN != errno) {
+              if (VERBOSE) {
+                std::cerr << "Reader of " << FIFO << " went away: "
+                          << std::strerror(errno) << std::endl;
+              }
+              ::close(fifoFd);
+              fifoFd = -1;
+            }
+          }
+        }
+      }
+    }
+
+    if (fifoFd >= 0) {
+      ::close(fifoFd);
+    }
+    for (int32_t fd : rawFds) {
+      ::close(fd);
+    }
+    std::cerr << "Simulated " << samples << " samples on " << configs.size()
+              << " channel(s); dropped scans=" << droppedScans
+              << " write errors=" << writeErrors
+              << " missed ticks=" << scheduler.missedDeadlines() << "."
+              << std::endl;
+  }
+  return retCode;
+}
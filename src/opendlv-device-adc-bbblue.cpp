@@ -15,15 +15,162 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <fstream>
+#include <sched.h>
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
+#include "acquisition-control.hpp"
+#include "adc-buffer.hpp"
+#include "adc-sampler.hpp"
+#include "channel-health.hpp"
 #include "cluon-complete.hpp"
+#include "deadband.hpp"
+#include "deadline-scheduler.hpp"
+#include "event-loop.hpp"
+#include "metrics.hpp"
+#include "metrics-server.hpp"
+#include "histogram.hpp"
+#include "od4-receiver.hpp"
+#include "od4-sender.hpp"
+#include "opendlv-device-adc-bbblue-message-set.hpp"
 #include "opendlv-standard-message-set.hpp"
+#include "publisher-thread.hpp"
+#include "raw-archive.hpp"
+#include "realtime.hpp"
+#include "recorder.hpp"
+#include "sample-ring.hpp"
+#include "shared-voltage-ring.hpp"
+#include "udp-batch-sender.hpp"
+#include "voltage-alarm.hpp"
+#include "voltage-envelope-encoder.hpp"
+#include "voltage-statistics.hpp"
+#include "voltage-batch.hpp"
+
+namespace {
+void printUsage(char const *name) {
+  std::cerr << name
+            << " interfaces to the analog-to-digital converters on the "
+               "BeagleBone Blue."
+            << std::endl;
+  std::cerr << "Usage:   " << name
+            << " --freq=<frequency> --cid=<OpenDaVINCI session> "
+               "--channel=<the ADC channel(s) to read, comma-separated> "
+               "[--id=<Identifier in case of multiple sensors; one per "
+               "channel, or a base for consecutive identifiers>] "
+               "[--conversion=<Factor from full scale to volts; one per "
+               "channel, or one for all>] [--mode=<sysfs (default) or "
+               "buffered>] [--iio-root=<IIO device directory holding "
+               "in_voltageN_raw, scan_elements/ and buffer/, default "
+               "/sys/bus/iio/devices/iio:device0>] [--device=<IIO character device, or a FIFO or "
+               "file in its format, for buffered mode>] [--buffer-length="
+               "<scans in the kernel buffer>] [--control=<path of a Unix "
+               "datagram socket accepting 'status' and 'stop'>] "
+               "[--realtime [--rt-priority=<SCHED_FIFO priority, default "
+               "50>] [--cpu=<CPU to pin the sampling thread to>]] "
+               "[--stats-period=<seconds between timing summaries sent as "
+               "opendlv.device.adc.TimingSummary>] [--batch=<samples per "
+               "opendlv.device.adc.VoltageReadingBatch message>] "
+               "[--batch-ms=<maximum age in milliseconds of a batch>] "
+               "[--deadband=<only send when a voltage moved more than this "
+               "many volts> [--heartbeat=<seconds after which a voltage is "
+               "sent anyway, default 1>]] [--sendmmsg [--flush-count=<"
+               "readings queued before they are sent with one sendmmsg "
+               "call, default 32>] [--flush-us=<microseconds a queued "
+               "reading may wait for later ticks before being sent, default "
+               "0>]] [--publisher-thread [--ring=<samples queued for the "
+               "publisher thread, default 4096>] [--overflow=<drop-oldest "
+               "(default) or drop-newest>]] [--shm=<name of a shared memory "
+               "area to publish every sample into for local readers> "
+               "[--shm-samples=<samples kept per channel, default 1024>]] "
+               "[--rec=<.rec file to record the sent voltages into> "
+               "[--rec-max-mb=<megabytes per file before rotating>] "
+               "[--rec-max-s=<seconds per file before rotating>] "
+               "[--rec-fsync=<none (default), rotate or write>]] "
+               "[--archive=<file to archive the raw codes into, compactly> "
+               "[--archive-block=<samples per block, 1 to 65535, default "
+               "1024>] "
+               "[--archive-max-mb=<megabytes per file before rotating>] "
+               "[--archive-max-s=<seconds per file before rotating>] "
+               "[--archive-fsync=<none (default), rotate or write>]] "
+               "[--summary=<seconds per window of "
+               "opendlv.device.adc.VoltageSummary messages> "
+               "[--summary-only]] [--alarm=<undervoltage rules as "
+               "<channel>:<threshold V>[:<release V>[:<minimum duration "
+               "ms>]], comma-separated>] [--remote-config (accept "
+               "opendlv.device.adc.AcquisitionRequest messages changing "
+               "rate, channels, deadband and batching at runtime)] "
+               "[--leases (sample at --freq, raised to the highest rate "
+               "asked for by unexpired opendlv.device.adc.SamplingLease "
+               "messages)] "
+               "[--metrics-port=<TCP port serving counters and timing "
+               "histograms over HTTP in the Prometheus text format> "
+               "[--metrics-address=<IPv4 address to serve them on, default "
+               "127.0.0.1; 0.0.0.0 for all interfaces>]] "
+               "[--health-period=<seconds between health messages: an "
+               "opendlv.system.SignalStatusMessage per channel and an "
+               "opendlv.system.SystemOperationState, giving the achieved "
+               "rate, error rate and last error code>] "
+               "[--verbose]"
+            << std::endl;
+  std::cerr << "Example: " << name << " --freq=10 --cid=111 --channel=0 "
+            << std::endl;
+  std::cerr << "         " << name
+            << " --freq=1000 --cid=111 --channel=6 --mode=buffered"
+            << std::endl;
+  std::cerr << "         " << name
+            << " --freq=10 --cid=111 --channel=0,1,5,6 --id=10" << std::endl;
+  std::cerr << "         " << name
+            << " --freq=100 --cid=111 --channel=6 --iio-root=/tmp/adc"
+            << std::endl;
+}
 
-// Lipo jack channel 6, conversion: 1.8*11 = 19.8
-// DC jack channel 5, conversion: 1.8*11 = 19.8
+// Parses a whole decimal number within [minimum, maximum], for options that
+// are narrowed to a smaller type.
+bool parseInRange(std::string const &text, int64_t minimum, int64_t maximum,
+                  int64_t &value) noexcept {
+  char *end{nullptr};
+  errno = 0;
+  long long const PARSED{std::strtoll(text.c_str(), &end, 10)};
+  if (text.empty() || end != text.c_str() + text.size() || ERANGE == errno ||
+      PARSED < minimum || PARSED > maximum) {
+    return false;
+  }
+  value = static_cast<int64_t>(PARSED);
+  return true;
+}
+
+// Parses a whole finite decimal number within [minimum, maximum].
+bool parseInRange(std::string const &text, float minimum, float maximum,
+                  float &value) noexcept {
+  char *end{nullptr};
+  errno = 0;
+  float const PARSED{std::strtof(text.c_str(), &end)};
+  if (text.empty() || end != text.c_str() + text.size() || ERANGE == errno ||
+      !std::isfinite(PARSED) || PARSED < minimum || PARSED > maximum) {
+    return false;
+  }
+  value = PARSED;
+  return true;
+}
+
+// Files are rotated after at most this many megabytes and seconds, and
+// summaries of the timing and the health are sent every 1 ms or more, up to
+// the longest period of a DeadlineScheduler.
+int64_t const MAX_FILE_MEGABYTES{1000000};
+int64_t const MAX_FILE_SECONDS{10000000};
+float const MIN_REPORT_PERIOD{0.001f};
+int64_t const MAX_REPORT_PERIOD{DeadlineScheduler::MAX_PERIOD / 1000000000};
+}  // namespace
 
 int32_t main(int32_t argc, char **argv) {
   int32_t retCode{0};
@@ -31,79 +178,1185 @@ int32_t main(int32_t argc, char **argv) {
   if (0 == commandlineArguments.count("cid") ||
       0 == commandlineArguments.count("freq") ||
       0 == commandlineArguments.count("channel")) {
-    std::cerr << argv[0]
-              << " interfaces to the analog-to-digital converters on the "
-                 "BeagleBone Blue."
-              << std::endl;
-    std::cerr << "Usage:   " << argv[0]
-              << " --freq=<frequency> --cid=<OpenDaVINCI session> "
-                 "--channel=<the ADC channel to read> [--id=<Identifier in "
-                 "case of multiple sensors] [--verbose]"
-              << std::endl;
-    std::cerr << "Example: " << argv[0] << " --freq=10 --cid=111 --channel=0 "
-              << std::endl;
+    printUsage(argv[0]);
     retCode = 1;
   } else {
-    uint32_t const ID{
-        (commandlineArguments["id"].size() != 0)
-            ? static_cast<uint32_t>(std::stoi(commandlineArguments["id"]))
-            : 0};
     bool const VERBOSE{commandlineArguments.count("verbose") != 0};
-    uint16_t const CID = std::stoi(commandlineArguments["cid"]);
-    std::string const CHANNELSTR = commandlineArguments["channel"];
-    float const FREQ = std::stof(commandlineArguments["freq"]);
-    // float const CONVERSION2VOLT =
-    // std::stof(commandlineArguments["conversion"]);
-    if (std::stoi(CHANNELSTR) < 0 && std::stoi(CHANNELSTR) > 6) {
-      std::cerr << "Not supported channel number, must be between 0 and 6."
+    int64_t cid{0};
+    if (!parseInRange(commandlineArguments["cid"], 1, 254, cid)) {
+      std::cerr << "Not supported CID, must be 1 to 254." << std::endl;
+      return 1;
+    }
+    uint16_t const CID{static_cast<uint16_t>(cid)};
+    float freq{0.0f};
+    if (!parseInRange(commandlineArguments["freq"], 0.0f,
+                      static_cast<float>(DeadlineScheduler::MAX_FREQUENCY),
+                      freq) ||
+        !(freq > 0.0f)) {
+      std::cerr << "Not supported frequency, must be above 0 and at most "
+                << DeadlineScheduler::MAX_FREQUENCY << " Hz." << std::endl;
+      return 1;
+    }
+    float const FREQ{freq};
+    // The channels with their per-channel state, and the settings that may
+    // be changed at runtime.
+    AcquisitionState state;
+    try {
+      state.configs = parseChannelConfigs(commandlineArguments["channel"],
+                                          commandlineArguments["id"],
+                                          commandlineArguments["conversion"]);
+    } catch (std::exception const &e) {
+      std::cerr << "Invalid channel configuration: " << e.what() << std::endl;
+      return 1;
+    }
+
+    std::string const MODE{(commandlineArguments["mode"].size() != 0)
+                               ? commandlineArguments["mode"]
+                               : "sysfs"};
+    std::string const IIO_DEVICE{
+        (commandlineArguments["iio-root"].size() != 0)
+            ? commandlineArguments["iio-root"]
+            : "/sys/bus/iio/devices/iio:device0"};
+
+    // Created before any other thread is started, so that all threads inherit
+    // the blocked termination signals.
+    EventLoop eventLoop;
+    if (!eventLoop.isValid()) {
+      std::cerr << "Failed to set up the event loop." << std::endl;
+      return 1;
+    }
+
+    // Nothing is received, so only the sending half of an OD4 session is set
+    // up, without the receiver and its threads.
+    Od4Sender od4{CID};
+
+    DeadlineScheduler scheduler(DeadlineScheduler::periodFromFrequency(FREQ));
+
+    // In buffered mode the device paces the capture, so its buffer is set up
+    // first and the sample period follows the rate the device settled on.
+    std::unique_ptr<AdcBuffer> adcBuffer;
+    std::string const DEVICE{(commandlineArguments["device"].size() != 0)
+                                 ? commandlineArguments["device"]
+                                 : "/dev/iio:device0"};
+    if (MODE == "buffered") {
+      int64_t bufferLength{128};
+      if (commandlineArguments["buffer-length"].size() != 0 &&
+          !parseInRange(commandlineArguments["buffer-length"], 1,
+                        AdcBuffer::MAX_LENGTH, bufferLength)) {
+        std::cerr << "Not supported buffer length, must be 1 to "
+                  << AdcBuffer::MAX_LENGTH << " scans." << std::endl;
+        return 1;
+      }
+      uint32_t const BUFFER_LENGTH{static_cast<uint32_t>(bufferLength)};
+      std::vector<uint8_t> channels;
+      for (auto const &config : state.configs) {
+        channels.push_back(config.channel);
+      }
+      adcBuffer.reset(
+          new AdcBuffer(IIO_DEVICE, DEVICE, channels, FREQ, BUFFER_LENGTH));
+      if (!adcBuffer->isOpen()) {
+        std::cerr << "Failed to open " << DEVICE << " for buffered capture."
+                  << std::endl;
+        return 1;
+      }
+      scheduler.setPeriod(DeadlineScheduler::periodFromFrequency(
+          adcBuffer->samplingFrequency()));
+    }
+
+    // Batching is enabled by giving a sample count, a maximum age, or both.
+    if (commandlineArguments["batch"].size() != 0 ||
+        commandlineArguments["batch-ms"].size() != 0) {
+      int64_t batchSize{VoltageBatch::MAX_SAMPLES};
+      if (commandlineArguments["batch"].size() != 0 &&
+          !parseInRange(commandlineArguments["batch"], 1,
+                        VoltageBatch::MAX_SAMPLES, batchSize)) {
+        std::cerr << "Not supported batch, must be 1 to "
+                  << VoltageBatch::MAX_SAMPLES << " samples." << std::endl;
+        return 1;
+      }
+      state.batchSize = static_cast<uint32_t>(batchSize);
+      float batchMs{0.0f};
+      if (commandlineArguments["batch-ms"].size() != 0 &&
+          !parseInRange(commandlineArguments["batch-ms"], 0.0f,
+                        static_cast<float>(VoltageBatch::MAX_AGE) / 1000.0f,
+                        batchMs)) {
+        std::cerr << "Not supported batch age, must be at most "
+                  << VoltageBatch::MAX_AGE / 1000 << " ms." << std::endl;
+        return 1;
+      }
+      state.batchAge = static_cast<int64_t>(batchMs * 1000.0f);
+      for (size_t i{0}; i < state.configs.size(); i++) {
+        state.batches.emplace_back(state.batchSize, state.batchAge,
+                                   scheduler.period());
+      }
+    }
+
+    float heartbeat{1.0f};
+    if (commandlineArguments["heartbeat"].size() != 0 &&
+        (!parseInRange(
+             commandlineArguments["heartbeat"], 0.0f,
+             static_cast<float>(DeadbandFilter::MAX_HEARTBEAT) / 1000000.0f,
+             heartbeat) ||
+         !(heartbeat > 0.0f))) {
+      std::cerr << "Not supported heartbeat, must be above 0 and at most "
+                << DeadbandFilter::MAX_HEARTBEAT / 1000000 << " s."
                 << std::endl;
+      return 1;
     }
-    uint8_t const CHANNELINT = std::stoi(CHANNELSTR);
-    float conversion2Volt;
-    if (CHANNELINT < 5) {
-      conversion2Volt = 1.8f;
-    } else {
-      conversion2Volt = 19.8f;
+    state.heartbeat = static_cast<int64_t>(heartbeat * 1000000.0f);
+    if (commandlineArguments["deadband"].size() != 0) {
+      if (!parseInRange(commandlineArguments["deadband"], 0.0f,
+                        std::numeric_limits<float>::max(), state.deadband)) {
+        std::cerr << "Not supported deadband, must be a finite voltage of at "
+                     "least 0 V."
+                  << std::endl;
+        return 1;
+      }
+      for (size_t i{0}; i < state.configs.size(); i++) {
+        state.deadbands.emplace_back(state.deadband, state.heartbeat);
+      }
+    }
+    auto deadbandSummary{[&state]() {
+      std::string summary;
+      for (size_t i{0}; i < state.deadbands.size(); i++) {
+        summary +=
+            "; channel " + std::to_string(state.configs[i].channel) +
+            ": published=" + std::to_string(state.deadbands[i].published()) +
+            " suppressed=" + std::to_string(state.deadbands[i].suppressed());
+      }
+      return summary;
+    }};
+
+    // Optionally, every sent envelope is also recorded by a background
+    // thread; recording only copies into a ring on the sending thread.
+    std::unique_ptr<Recorder> recorder;
+    if (commandlineArguments["rec"].size() != 0) {
+      float recMaxMegabytes{0.0f};
+      if (commandlineArguments["rec-max-mb"].size() != 0 &&
+          !parseInRange(commandlineArguments["rec-max-mb"], 0.0f,
+                        static_cast<float>(MAX_FILE_MEGABYTES),
+                        recMaxMegabytes)) {
+        std::cerr << "Not supported recording size, must be 0 to "
+                  << MAX_FILE_MEGABYTES << " MB." << std::endl;
+        return 1;
+      }
+      float recMaxSeconds{0.0f};
+      if (commandlineArguments["rec-max-s"].size() != 0 &&
+          !parseInRange(commandlineArguments["rec-max-s"], 0.0f,
+                        static_cast<float>(MAX_FILE_SECONDS),
+                        recMaxSeconds)) {
+        std::cerr << "Not supported recording duration, must be 0 to "
+                  << MAX_FILE_SECONDS << " s." << std::endl;
+        return 1;
+      }
+      uint64_t const REC_MAX_BYTES{
+          static_cast<uint64_t>(static_cast<double>(recMaxMegabytes) * 1.0e6)};
+      int64_t const REC_MAX_AGE{
+          static_cast<int64_t>(static_cast<double>(recMaxSeconds) * 1.0e9)};
+      FsyncPolicy fsyncPolicy{FsyncPolicy::None};
+      if (commandlineArguments["rec-fsync"].size() != 0 &&
+          !parseFsyncPolicy(commandlineArguments["rec-fsync"], fsyncPolicy)) {
+        std::cerr << "Unknown fsync policy '"
+                  << commandlineArguments["rec-fsync"] << "'." << std::endl;
+        return 1;
+      }
+      // Readings are recorded by the thread that sends them, alarms by the
+      // sampling thread, so each gets a ring of its own.
+      recorder.reset(new Recorder(commandlineArguments["rec"],
+                                  4 * 1024 * 1024, REC_MAX_BYTES, REC_MAX_AGE,
+                                  fsyncPolicy, 100000000, 2));
+      if (!recorder->isOpen()) {
+        std::cerr << "Failed to open " << commandlineArguments["rec"]
+                  << " for recording." << std::endl;
+        return 1;
+      }
+    }
+
+    // Optionally, counters are kept for a metrics endpoint. They are updated
+    // with relaxed atomics, and the endpoint reads them from its own thread.
+    std::unique_ptr<AcquisitionMetrics> metrics;
+    int64_t metricsPort{0};
+    if (commandlineArguments["metrics-port"].size() != 0 &&
+        !parseInRange(commandlineArguments["metrics-port"], 1, 65535,
+                      metricsPort)) {
+      std::cerr << "Not supported metrics port, must be 1 to 65535."
+                << std::endl;
+      return 1;
+    }
+    uint16_t const METRICS_PORT{static_cast<uint16_t>(metricsPort)};
+    std::string const METRICS_ADDRESS{
+        (commandlineArguments["metrics-address"].size() != 0)
+            ? commandlineArguments["metrics-address"]
+            : "127.0.0.1"};
+    if (METRICS_PORT > 0) {
+      metrics.reset(new AcquisitionMetrics());
     }
 
-    cluon::OD4Session od4{CID};
+    // Single readings bypass OD4Session::send: the datagram is encoded into a
+    // fixed buffer and handed to the sender in a string with reserved
+    // capacity, which UDPSender::send only reads from.
+    VoltageEnvelopeEncoder voltageEncoder{
+        opendlv::proxy::VoltageReading::ID()};
+    cluon::UDPSender &voltageSender{od4.sender()};
+    std::string datagram;
+    datagram.reserve(VoltageEnvelopeEncoder::MAX_SIZE);
 
-    auto atFrequency{[&conversion2Volt, &CHANNELSTR, &CHANNELINT, &ID, &VERBOSE,
-                      &od4]() -> bool {
-      int32_t output{0};
-      std::ifstream adcNode("/sys/bus/iio/devices/iio:device0/in_voltage" +
-                            CHANNELSTR + "_raw");
-      if (adcNode.is_open()) {
-        std::string str;
-        std::getline(adcNode, str);
-        output = std::stoi(str);
+    // Optionally, the readings of a tick are queued and sent together with
+    // one sendmmsg call when the tick ends, or at the latest once the queue
+    // is full or the oldest reading waited longer than --flush-us.
+    std::unique_ptr<UdpBatchSender> batchSender;
+    if (commandlineArguments.count("sendmmsg") != 0) {
+      int64_t flushCount{32};
+      if (commandlineArguments["flush-count"].size() != 0 &&
+          !parseInRange(commandlineArguments["flush-count"], 1,
+                        static_cast<int64_t>(UdpBatchSender::MAX_QUEUE),
+                        flushCount)) {
+        std::cerr << "Not supported flush count, must be 1 to "
+                  << UdpBatchSender::MAX_QUEUE << " readings." << std::endl;
+        return 1;
+      }
+      int64_t flushMicroseconds{0};
+      if (commandlineArguments["flush-us"].size() != 0 &&
+          !parseInRange(commandlineArguments["flush-us"], 0,
+                        UdpBatchSender::MAX_DELAY / 1000, flushMicroseconds)) {
+        std::cerr << "Not supported flush delay, must be 0 to "
+                  << UdpBatchSender::MAX_DELAY / 1000 << " us." << std::endl;
+        return 1;
+      }
+      batchSender.reset(new UdpBatchSender(
+          "225.0.0." + std::to_string(CID), 12175,
+          static_cast<size_t>(flushCount), flushMicroseconds * 1000));
+      if (!batchSender->isOpen()) {
+        std::cerr << "Failed to open the sendmmsg socket." << std::endl;
+        return 1;
+      }
+    }
+    auto flushSender{[&batchSender]() {
+      if (batchSender) {
+        batchSender->onTickEnd(DeadlineScheduler::now());
+      }
+    }};
+
+    auto sendDatagram{[&voltageSender, &datagram, &batchSender, &recorder,
+                       &metrics](char const *data, size_t size) {
+      if (recorder) {
+        recorder->record(data, size);
+      }
+      if (batchSender) {
+        batchSender->send(data, size, DeadlineScheduler::now());
       } else {
-        std::cerr << "Failed to read from "
-                     "/sys/bus/iio/devices/iio:device0/in_voltage" +
-                         CHANNELSTR + "_raw."
-                  << std::endl;
+        datagram.assign(data, size);
+        auto const RESULT{voltageSender.send(std::move(datagram))};
+        if (metrics) {
+          metrics->addSent(RESULT.first, RESULT.second);
+        }
+      }
+    }};
+
+    auto sendVoltageReading{[&voltageEncoder, &sendDatagram](
+                                float voltage,
+                                cluon::data::TimeStamp const &sampleTime,
+                                uint32_t senderStamp) {
+      char buffer[VoltageEnvelopeEncoder::MAX_SIZE];
+      cluon::data::TimeStamp const SENT{cluon::time::now()};
+      size_t const SIZE{voltageEncoder.encode(
+          buffer, voltage, SENT.seconds(), SENT.microseconds(),
+          sampleTime.seconds(), sampleTime.microseconds(), senderStamp)};
+      sendDatagram(buffer, SIZE);
+    }};
+
+    // Other messages are serialized as OD4Session::send would, so that they
+    // take the same way as single readings.
+    auto sendMessage{[&sendDatagram](auto &message,
+                                     cluon::data::TimeStamp const &sampleTime,
+                                     uint32_t senderStamp) {
+      std::string const DATA{
+          Od4Sender::serialize(message, sampleTime, senderStamp)};
+      sendDatagram(DATA.data(), DATA.size());
+    }};
+
+    auto flushBatch{[&state, &sendMessage](size_t index) {
+      VoltageBatch &batch{state.batches[index]};
+      if (batch.isEmpty()) {
+        return;
       }
-      adcNode.close();
-      float voltage{output * conversion2Volt / 4095.0f};
+      opendlv::device::adc::VoltageReadingBatch voltageReadingBatch;
+      voltageReadingBatch.baseTimeStamp(batch.baseTimeStamp());
+      voltageReadingBatch.samplePeriod(static_cast<uint64_t>(batch.period()));
+      voltageReadingBatch.channel(state.configs[index].channel);
+      voltageReadingBatch.samples(batch.samples());
+      voltageReadingBatch.sequenceNumber(batch.clear());
+      sendMessage(voltageReadingBatch,
+                  cluon::time::fromMicroseconds(
+                      voltageReadingBatch.baseTimeStamp()),
+                  state.configs[index].senderStamp);
+    }};
 
-      if (CHANNELINT == 5) {
-        voltage += -0.15f;
-      } else if (CHANNELINT == 6) {
-        voltage += -0.1f;
+    // Per-channel summaries over tumbling windows, computed from every
+    // reading before deadband and batching.
+    bool const SUMMARY_ONLY{commandlineArguments.count("summary-only") != 0};
+    float summary{0.0f};
+    if (commandlineArguments["summary"].size() != 0 &&
+        (!parseInRange(
+             commandlineArguments["summary"], 0.0f,
+             static_cast<float>(VoltageStatistics::MAX_WINDOW) / 1000000.0f,
+             summary) ||
+         !(summary > 0.0f))) {
+      std::cerr << "Not supported summary window, must be above 0 and at most "
+                << VoltageStatistics::MAX_WINDOW / 1000000 << " s."
+                << std::endl;
+      return 1;
+    }
+    int64_t const SUMMARY_WINDOW{static_cast<int64_t>(summary * 1000000.0f)};
+    state.summaryWindow = SUMMARY_WINDOW;
+    if (SUMMARY_WINDOW > 0) {
+      for (size_t i{0}; i < state.configs.size(); i++) {
+        state.statistics.emplace_back(SUMMARY_WINDOW);
+      }
+    }
+    auto flushSummary{[&state, &sendMessage](size_t index) {
+      VoltageStatistics &window{state.statistics[index]};
+      if (0 == window.count()) {
+        return;
       }
+      opendlv::device::adc::VoltageSummary voltageSummary;
+      voltageSummary.windowStart(window.windowStart());
+      voltageSummary.windowDuration(static_cast<uint64_t>(window.window()));
+      voltageSummary.channel(state.configs[index].channel);
+      voltageSummary.count(window.count());
+      voltageSummary.minimum(window.minimum());
+      voltageSummary.maximum(window.maximum());
+      voltageSummary.mean(window.mean());
+      voltageSummary.variance(window.variance());
+      voltageSummary.standardDeviation(std::sqrt(window.variance()));
+      window.clear();
+      sendMessage(voltageSummary,
+                  cluon::time::fromMicroseconds(voltageSummary.windowStart()),
+                  state.configs[index].senderStamp);
+    }};
 
-      opendlv::proxy::VoltageReading voltageReading;
-      voltageReading.voltage(voltage);
-      cluon::data::TimeStamp sampleTime = cluon::time::now();
-      od4.send(voltageReading, sampleTime, ID);
+    auto sendVoltage{[&VERBOSE, &state, &flushSummary, SUMMARY_ONLY,
+                      &flushBatch, &sendVoltageReading](
+                         size_t index, float const VOLTAGE,
+                         cluon::data::TimeStamp sampleTime) {
+      AdcChannelConfig const &config{state.configs[index]};
+      if (!state.statistics.empty()) {
+        int64_t const SAMPLE_TIME{cluon::time::toMicroseconds(sampleTime)};
+        if (!state.statistics[index].isInWindow(SAMPLE_TIME)) {
+          flushSummary(index);
+        }
+        state.statistics[index].add(VOLTAGE, SAMPLE_TIME);
+        if (SUMMARY_ONLY) {
+          return;
+        }
+      }
+      if (!state.deadbands.empty() &&
+          !state.deadbands[index].pass(
+              VOLTAGE, cluon::time::toMicroseconds(sampleTime))) {
+        return;
+      }
+      if (state.batches.empty()) {
+        sendVoltageReading(VOLTAGE, sampleTime, config.senderStamp);
+      } else {
+        VoltageBatch &batch{state.batches[index]};
+        int64_t const SAMPLE_TIME{cluon::time::toMicroseconds(sampleTime)};
+        if (!batch.fits(SAMPLE_TIME)) {
+          flushBatch(index);
+        }
+        batch.add(VOLTAGE, SAMPLE_TIME);
+        if (batch.isFull(SAMPLE_TIME)) {
+          flushBatch(index);
+        }
+      }
 
       if (VERBOSE) {
-        std::cout << "Voltage reading: " << voltageReading.voltage() << " V."
+        std::cout << "Voltage reading on channel " << +config.channel << ": "
+                  << VOLTAGE << " V." << std::endl;
+      }
+    }};
+
+    // Batches are also checked for their age at the end of every tick, so
+    // that one is sent in time when the deadband suppresses samples or reads
+    // fail.
+    auto onTickEnd{[&state, &flushBatch, &flushSender]() {
+      if (!state.batches.empty()) {
+        int64_t const NOW{cluon::time::toMicroseconds(cluon::time::now())};
+        for (size_t i{0}; i < state.batches.size(); i++) {
+          if (state.batches[i].isFull(NOW)) {
+            flushBatch(i);
+          }
+        }
+      }
+      flushSender();
+    }};
+
+    // Optionally, the sampling thread only reads, converts and timestamps;
+    // encoding and sending happen on a publisher thread fed through a ring.
+    std::unique_ptr<SampleRing> sampleRing;
+    std::unique_ptr<PublisherThread> publisherThread;
+    if (commandlineArguments.count("publisher-thread") != 0) {
+      int64_t ring{4096};
+      if (commandlineArguments["ring"].size() != 0 &&
+          !parseInRange(commandlineArguments["ring"], 1,
+                        static_cast<int64_t>(SampleRing::MAX_CAPACITY),
+                        ring)) {
+        std::cerr << "Not supported ring, must be 1 to "
+                  << SampleRing::MAX_CAPACITY << " samples." << std::endl;
+        return 1;
+      }
+      size_t const RING{static_cast<size_t>(ring)};
+      OverflowPolicy policy{OverflowPolicy::DropOldest};
+      if (commandlineArguments["overflow"].size() != 0 &&
+          !parseOverflowPolicy(commandlineArguments["overflow"], policy)) {
+        std::cerr << "Unknown overflow policy '"
+                  << commandlineArguments["overflow"] << "'." << std::endl;
+        return 1;
+      }
+      sampleRing.reset(new SampleRing(RING, policy));
+    }
+    auto startPublisherThread{[&publisherThread, &sampleRing, &sendVoltage,
+                               &onTickEnd]() {
+      publisherThread.reset(new PublisherThread(
+          *sampleRing,
+          [&sendVoltage](SampleRecord const &record) {
+            sendVoltage(record.index, record.voltage,
+                        cluon::time::fromMicroseconds(record.sampleTime));
+          },
+          onTickEnd));
+      return publisherThread->isRunning();
+    }};
+    if (sampleRing) {
+      if (!startPublisherThread()) {
+        std::cerr << "Failed to start the publisher thread." << std::endl;
+        return 1;
+      }
+    }
+    // Reports from the sampling thread are sent and recorded like the
+    // readings, by the thread that sends those.
+    auto sendReport{[&publisherThread, &sendDatagram](
+                        auto &message, cluon::data::TimeStamp const &sampleTime,
+                        uint32_t senderStamp) {
+      std::string const DATA{
+          Od4Sender::serialize(message, sampleTime, senderStamp)};
+      if (publisherThread) {
+        publisherThread->post([&sendDatagram, DATA]() {
+          sendDatagram(DATA.data(), DATA.size());
+        });
+      } else {
+        sendDatagram(DATA.data(), DATA.size());
+      }
+    }};
+    auto ringSummary{[&sampleRing]() {
+      return sampleRing ? " " + sampleRing->summary() : std::string();
+    }};
+
+    // Local readers get every sample straight from the sampling thread,
+    // before deadband and batching.
+    std::unique_ptr<SharedVoltageRing> sharedVoltageRing;
+    if (commandlineArguments["shm"].size() != 0) {
+      int64_t shmSamples{1024};
+      if (commandlineArguments["shm-samples"].size() != 0 &&
+          !parseInRange(commandlineArguments["shm-samples"], 1,
+                        SharedVoltageRing::MAX_CAPACITY, shmSamples)) {
+        std::cerr << "Not supported shared memory samples, must be 1 to "
+                  << SharedVoltageRing::MAX_CAPACITY << " per channel."
                   << std::endl;
+        return 1;
       }
-      return od4.isRunning();
+      uint32_t const SHM_SAMPLES{static_cast<uint32_t>(shmSamples)};
+      sharedVoltageRing.reset(new SharedVoltageRing(
+          commandlineArguments["shm"], state.configs, SHM_SAMPLES));
+      if (!sharedVoltageRing->isValid()) {
+        std::cerr << "Failed to create shared memory "
+                  << commandlineArguments["shm"] << "." << std::endl;
+        return 1;
+      }
+    }
+
+    // Raw codes are archived in delta-encoded blocks, each written out by a
+    // background Recorder once it is full or the time grid breaks.
+    std::unique_ptr<Recorder> archiver;
+    int64_t archiveBlock{1024};
+    if (commandlineArguments["archive-block"].size() != 0 &&
+        !parseInRange(commandlineArguments["archive-block"], 1,
+                      ArchiveBlockEncoder::MAX_SAMPLES, archiveBlock)) {
+      std::cerr << "Not supported archive block, must be 1 to "
+                << ArchiveBlockEncoder::MAX_SAMPLES << " samples."
+                << std::endl;
+      printUsage(argv[0]);
+      return 1;
+    }
+    uint16_t const ARCHIVE_BLOCK{static_cast<uint16_t>(archiveBlock)};
+    state.archiveBlock = ARCHIVE_BLOCK;
+    if (commandlineArguments["archive"].size() != 0) {
+      float archiveMaxMegabytes{0.0f};
+      if (commandlineArguments["archive-max-mb"].size() != 0 &&
+          !parseInRange(commandlineArguments["archive-max-mb"], 0.0f,
+                        static_cast<float>(MAX_FILE_MEGABYTES),
+                        archiveMaxMegabytes)) {
+        std::cerr << "Not supported archive size, must be 0 to "
+                  << MAX_FILE_MEGABYTES << " MB." << std::endl;
+        return 1;
+      }
+      float archiveMaxSeconds{0.0f};
+      if (commandlineArguments["archive-max-s"].size() != 0 &&
+          !parseInRange(commandlineArguments["archive-max-s"], 0.0f,
+                        static_cast<float>(MAX_FILE_SECONDS),
+                        archiveMaxSeconds)) {
+        std::cerr << "Not supported archive duration, must be 0 to "
+                  << MAX_FILE_SECONDS << " s." << std::endl;
+        return 1;
+      }
+      uint64_t const ARCHIVE_MAX_BYTES{static_cast<uint64_t>(
+          static_cast<double>(archiveMaxMegabytes) * 1.0e6)};
+      int64_t const ARCHIVE_MAX_AGE{
+          static_cast<int64_t>(static_cast<double>(archiveMaxSeconds) * 1.0e9)};
+      FsyncPolicy fsyncPolicy{FsyncPolicy::None};
+      if (commandlineArguments["archive-fsync"].size() != 0 &&
+          !parseFsyncPolicy(commandlineArguments["archive-fsync"],
+                            fsyncPolicy)) {
+        std::cerr << "Unknown fsync policy '"
+                  << commandlineArguments["archive-fsync"] << "'."
+                  << std::endl;
+        return 1;
+      }
+      archiver.reset(new Recorder(commandlineArguments["archive"], 1024 * 1024,
+                                  ARCHIVE_MAX_BYTES, ARCHIVE_MAX_AGE,
+                                  fsyncPolicy, 1000000000));
+      if (!archiver->isOpen()) {
+        std::cerr << "Failed to open " << commandlineArguments["archive"]
+                  << " for archiving." << std::endl;
+        return 1;
+      }
+      for (auto const &config : state.configs) {
+        state.archiveBlocks.emplace_back(config, ARCHIVE_BLOCK,
+                                         scheduler.period());
+      }
+    }
+    auto flushArchiveBlock{[&archiver, &state](size_t index) {
+      ArchiveBlockEncoder &block{state.archiveBlocks[index]};
+      if (!block.isEmpty()) {
+        archiver->record(block.data(), block.size());
+        block.clear();
+      }
+    }};
+
+    TimingStatistics timingStatistics;
+
+    // Undervoltage rules are evaluated on every sample in the sampling
+    // thread. State changes go out right away on a socket of their own,
+    // ahead of anything queued, batched or filtered by deadband, and are
+    // recorded and archived along with the readings.
+    state.alarms.resize(state.configs.size());
+    std::unique_ptr<cluon::UDPSender> alarmSender;
+    if (commandlineArguments["alarm"].size() != 0) {
+      try {
+        state.alarmRules = parseAlarmRules(commandlineArguments["alarm"]);
+      } catch (std::exception const &e) {
+        std::cerr << "Invalid alarm rule: " << e.what() << std::endl;
+        return 1;
+      }
+      for (auto const &rule : state.alarmRules) {
+        size_t index{0};
+        while (index < state.configs.size() &&
+               state.configs[index].channel != rule.channel) {
+          index++;
+        }
+        // With remote configuration, the channel may be added later.
+        if (index == state.configs.size()) {
+          if (commandlineArguments.count("remote-config") != 0) {
+            continue;
+          }
+          std::cerr << "Alarm rule for channel " << +rule.channel
+                    << ", which is not sampled." << std::endl;
+          return 1;
+        }
+        state.alarms[index].emplace_back(rule);
+      }
+      alarmSender.reset(
+          new cluon::UDPSender{"225.0.0." + std::to_string(CID), 12175});
+    }
+    auto checkAlarms{[&state, &alarmSender, &recorder, &archiver,
+                       &timingStatistics, &metrics](
+                         size_t index, float voltage,
+                         cluon::data::TimeStamp const &sampleTime,
+                         int64_t readTime) {
+      for (auto &alarm : state.alarms[index]) {
+        VoltageAlarm::Transition const TRANSITION{
+            alarm.update(voltage, cluon::time::toMicroseconds(sampleTime))};
+        if (VoltageAlarm::NONE == TRANSITION) {
+          continue;
+        }
+        opendlv::device::adc::VoltageAlarm voltageAlarm;
+        voltageAlarm.channel(alarm.rule().channel);
+        voltageAlarm.isActive(alarm.isActive());
+        voltageAlarm.voltage(voltage);
+        voltageAlarm.threshold(alarm.rule().threshold);
+        voltageAlarm.release(alarm.rule().release);
+        voltageAlarm.since(alarm.since());
+        std::string const DATA{Od4Sender::serialize(
+            voltageAlarm, sampleTime, state.configs[index].senderStamp)};
+        auto const RESULT{alarmSender->send(std::string(DATA))};
+        if (metrics) {
+          metrics->addSent(RESULT.first, RESULT.second);
+        }
+        timingStatistics.alarmLatency.record(DeadlineScheduler::now() -
+                                             readTime);
+        if (recorder) {
+          recorder->record(DATA.data(), DATA.size(), 1);
+        }
+        if (archiver) {
+          ArchiveAlarm archiveAlarm;
+          archiveAlarm.channel = alarm.rule().channel;
+          archiveAlarm.isActive = alarm.isActive();
+          archiveAlarm.timeStamp = cluon::time::toMicroseconds(sampleTime);
+          archiveAlarm.since = alarm.since();
+          archiveAlarm.senderStamp = state.configs[index].senderStamp;
+          archiveAlarm.voltage = voltage;
+          archiveAlarm.threshold = alarm.rule().threshold;
+          archiveAlarm.release = alarm.rule().release;
+          char record[ARCHIVE_ALARM_SIZE];
+          encodeArchiveAlarm(archiveAlarm, record);
+          archiver->record(record, sizeof(record));
+        }
+        std::cerr << "Undervoltage alarm on channel " << +alarm.rule().channel
+                  << (alarm.isActive() ? " raised" : " cleared") << " at "
+                  << voltage << " V." << std::endl;
+      }
+    }};
+
+    auto publish{[&state, &checkAlarms, &sharedVoltageRing,
+                  &flushArchiveBlock, &sampleRing, &sendVoltage](
+                     size_t index, int32_t output,
+                     cluon::data::TimeStamp const &sampleTime,
+                     int64_t readTime) {
+      float const VOLTAGE{toVoltage(state.configs[index], output)};
+      checkAlarms(index, VOLTAGE, sampleTime, readTime);
+      if (!state.archiveBlocks.empty()) {
+        int64_t const SAMPLE_TIME{cluon::time::toMicroseconds(sampleTime)};
+        if (!state.archiveBlocks[index].add(output, SAMPLE_TIME)) {
+          flushArchiveBlock(index);
+          state.archiveBlocks[index].add(output, SAMPLE_TIME);
+        }
+      }
+      if (sharedVoltageRing) {
+        sharedVoltageRing->write(index, VOLTAGE,
+                                 cluon::time::toMicroseconds(sampleTime));
+      }
+      if (sampleRing) {
+        SampleRecord record;
+        record.sampleTime = cluon::time::toMicroseconds(sampleTime);
+        record.voltage = VOLTAGE;
+        record.index = static_cast<uint32_t>(index);
+        sampleRing->push(record);
+      } else {
+        sendVoltage(index, VOLTAGE, sampleTime);
+      }
+    }};
+    auto endTick{[&publisherThread, &onTickEnd]() {
+      if (publisherThread) {
+        publisherThread->notify();
+      } else {
+        onTickEnd();
+      }
+    }};
+
+    // The jitter is the deviation from the nominal period, which is only
+    // known when ticks are scheduled; a block read wakes up whenever the
+    // device has filled its watermark, so it passes no nominal period.
+    int64_t lastTick{0};
+    auto recordPeriod{[&timingStatistics, &lastTick](int64_t tick,
+                                                     int64_t nominal) {
+      if (lastTick > 0) {
+        int64_t const PERIOD{tick - lastTick};
+        timingStatistics.period.record(PERIOD);
+        if (nominal > 0) {
+          timingStatistics.jitter.record(std::llabs(PERIOD - nominal));
+        }
+      }
+      lastTick = tick;
+    }};
+    state.outputs.assign(state.configs.size(), 0);
+    state.health.resize(state.configs.size());
+
+    // Optionally, the acquisition is changed at runtime through
+    // opendlv.device.adc.AcquisitionRequest, and with --leases sampling is
+    // demand-driven: --freq is the idle rate, raised to the highest rate
+    // leased through opendlv.device.adc.SamplingLease until the leases
+    // expire. Both take effect at the start of the next tick.
+    auto openSampler{[&IIO_DEVICE](
+                         std::vector<AdcChannelConfig> const &newConfigs) {
+      std::unique_ptr<AdcSampler> sampler{
+          new AdcSampler(IIO_DEVICE, newConfigs)};
+      for (size_t i{0}; i < sampler->size(); i++) {
+        if (!sampler->channel(i).isOpen()) {
+          std::cerr << "Failed to open " << sampler->channel(i).path() << "."
+                    << std::endl;
+        }
+      }
+      return sampler;
+    }};
+    AcquisitionControl control(state, scheduler, openSampler,
+                               MODE == "buffered",
+                               sharedVoltageRing != nullptr);
+    if (commandlineArguments.count("leases") != 0) {
+      if (MODE == "buffered") {
+        std::cerr << "Leases need sysfs mode, as the rate of buffered "
+                     "capture is fixed."
+                  << std::endl;
+        return 1;
+      }
+      control.enableLeases(FREQ, 64);
+    }
+
+    auto reconfigure{[&control, &state, &publisherThread,
+                      &startPublisherThread, &flushBatch, &flushSummary,
+                      &flushArchiveBlock, &scheduler]() {
+      if (!control.isPending()) {
+        return;
+      }
+      // The publisher thread works on the per-channel state, so it is
+      // drained and stopped while that changes.
+      bool const HAS_PUBLISHER_THREAD{publisherThread != nullptr};
+      if (HAS_PUBLISHER_THREAD) {
+        publisherThread->stop();
+      }
+      for (size_t i{0}; i < state.batches.size(); i++) {
+        flushBatch(i);
+      }
+      for (size_t i{0}; i < state.archiveBlocks.size(); i++) {
+        flushArchiveBlock(i);
+      }
+      control.apply([&state, &flushSummary](size_t index) {
+        if (!state.statistics.empty()) {
+          flushSummary(index);
+        }
+      });
+
+      if (HAS_PUBLISHER_THREAD && !startPublisherThread()) {
+        std::cerr << "Failed to restart the publisher thread." << std::endl;
+      }
+      std::cerr << "Reconfigured to " << state.configs.size()
+                << " channel(s) at "
+                << 1.0e9 / static_cast<double>(scheduler.period()) << " Hz";
+      if (!state.deadbands.empty()) {
+        std::cerr << ", deadband " << state.deadband << " V";
+      }
+      if (!state.batches.empty()) {
+        std::cerr << ", batches of " << state.batchSize;
+      }
+      std::cerr << "." << std::endl;
     }};
-    od4.timeTrigger(FREQ, atFrequency);
+    if (MODE == "buffered") {
+      // Scans in a block are back-dated from the time of the read by the
+      // sample period of the device, the last scan being the most recent one.
+      int64_t const PERIOD_IN_MICROSECONDS{scheduler.period() / 1000};
+      auto onScans{[&adcBuffer, &state, &publish, &endTick, &eventLoop,
+                    PERIOD_IN_MICROSECONDS, DEVICE, &timingStatistics,
+                    &recordPeriod, &reconfigure, &metrics]() {
+        reconfigure();
+        int64_t const BEFORE_READ{DeadlineScheduler::now()};
+        int32_t const SCANS{adcBuffer->read()};
+        int64_t const AFTER_READ{DeadlineScheduler::now()};
+        if (SCANS < 0) {
+          std::cerr << "Failed to read from " << DEVICE << "." << std::endl;
+          eventLoop.stop();
+          return;
+        }
+        if (SCANS > 0) {
+          recordPeriod(BEFORE_READ, 0);
+          timingStatistics.readLatency.record(AFTER_READ - BEFORE_READ);
+        }
+        int64_t const NOW{cluon::time::toMicroseconds(cluon::time::now())};
+        for (int32_t scan{0}; scan < SCANS; scan++) {
+          cluon::data::TimeStamp const SAMPLE_TIME{cluon::time::fromMicroseconds(
+              NOW - (SCANS - 1 - scan) * PERIOD_IN_MICROSECONDS)};
+          for (size_t i{0}; i < state.configs.size(); i++) {
+            publish(i, adcBuffer->raw(static_cast<size_t>(scan), i),
+                    SAMPLE_TIME, BEFORE_READ);
+            state.health[i].addRead(0);
+            if (metrics) {
+              metrics->addRead(state.configs[i].channel, 0);
+            }
+          }
+        }
+        if (SCANS > 0) {
+          endTick();
+          timingStatistics.sendLatency.record(DeadlineScheduler::now() -
+                                              AFTER_READ);
+        }
+        if (adcBuffer->isEndOfStream()) {
+          eventLoop.stop();
+        }
+      }};
+      eventLoop.addReader(adcBuffer->fd(), onScans);
+    } else {
+      state.sampler = openSampler(state.configs);
+
+      // All channels are read in the same tick and share its sample time.
+      auto atFrequency{[&state, &publish, &endTick, &timingStatistics,
+                        &recordPeriod, &control, &reconfigure, &metrics,
+                        &scheduler]() {
+        control.expireLeases(DeadlineScheduler::now());
+        reconfigure();
+        int64_t const BEFORE_READ{DeadlineScheduler::now()};
+        recordPeriod(BEFORE_READ, scheduler.period());
+        cluon::data::TimeStamp const SAMPLE_TIME{cluon::time::now()};
+        // A failed read is not published; it shows in the health messages,
+        // and is logged when a channel starts and stops failing.
+        for (size_t i{0}; i < state.sampler->size(); i++) {
+          AdcChannel const &channel{state.sampler->channel(i)};
+          int32_t const ERROR{state.sampler->read(i, state.outputs[i])
+                                  ? 0
+                                  : channel.lastError()};
+          if (state.health[i].addRead(ERROR)) {
+            if (0 == ERROR) {
+              std::cerr << "Reading from " << channel.path() << " again."
+                        << std::endl;
+            } else {
+              std::cerr << "Failed to read from " << channel.path() << ": "
+                        << std::strerror(ERROR) << "." << std::endl;
+            }
+          }
+          if (metrics) {
+            metrics->addRead(state.sampler->config(i).channel, ERROR);
+          }
+        }
+        if (metrics) {
+          metrics->setSchedule(scheduler.ticks(), scheduler.missedDeadlines(),
+                               scheduler.period());
+        }
+        int64_t const AFTER_READ{DeadlineScheduler::now()};
+        timingStatistics.readLatency.record(AFTER_READ - BEFORE_READ);
+        for (size_t i{0}; i < state.sampler->size(); i++) {
+          if (state.health[i].isHealthy()) {
+            publish(i, state.outputs[i], SAMPLE_TIME, BEFORE_READ);
+          }
+        }
+        endTick();
+        timingStatistics.sendLatency.record(DeadlineScheduler::now() -
+                                            AFTER_READ);
+      }};
+      if (!eventLoop.addTimer(scheduler, atFrequency)) {
+        std::cerr << "Failed to set up the sampling timer." << std::endl;
+        return 1;
+      }
+    }
+
+    std::unique_ptr<Od4Receiver> od4Receiver;
+    if (commandlineArguments.count("remote-config") != 0 ||
+        control.hasLeases()) {
+      od4Receiver.reset(new Od4Receiver(CID, voltageSender.getSendFromPort()));
+      if (!od4Receiver->isOpen() ||
+          !eventLoop.addReader(od4Receiver->fd(),
+                               [&od4Receiver]() { od4Receiver->receive(); })) {
+        std::cerr << "Failed to join OD4 session " << CID
+                  << " to receive requests." << std::endl;
+        return 1;
+      }
+    }
+    if (commandlineArguments.count("remote-config") != 0) {
+      auto onAcquisitionRequest{[&control](cluon::data::Envelope &&envelope) {
+        auto request =
+            cluon::extractMessage<opendlv::device::adc::AcquisitionRequest>(
+                std::move(envelope));
+        std::string reason;
+        if (!control.request(request, reason)) {
+          std::cerr << "Ignored acquisition request: " << reason << "."
+                    << std::endl;
+        }
+      }};
+      od4Receiver->dataTrigger(opendlv::device::adc::AcquisitionRequest::ID(),
+                               onAcquisitionRequest);
+    }
+    if (control.hasLeases()) {
+      auto onSamplingLease{[&control, VERBOSE](
+                               cluon::data::Envelope &&envelope) {
+        uint32_t const HOLDER{envelope.senderStamp()};
+        auto request =
+            cluon::extractMessage<opendlv::device::adc::SamplingLease>(
+                std::move(envelope));
+        std::string reason;
+        if (!control.lease(HOLDER, request, DeadlineScheduler::now(),
+                           reason)) {
+          std::cerr << "Ignored lease of channel " << +request.channel()
+                    << " at " << request.frequency() << " Hz for "
+                    << request.duration() << " s: " << reason << "."
+                    << std::endl;
+        } else if (VERBOSE) {
+          std::cerr << "Lease of channel " << +request.channel() << " by "
+                    << HOLDER << " at " << request.frequency() << " Hz for "
+                    << request.duration() << " s." << std::endl;
+        }
+      }};
+      od4Receiver->dataTrigger(opendlv::device::adc::SamplingLease::ID(),
+                               onSamplingLease);
+    }
+
+    if (commandlineArguments["control"].size() != 0) {
+      auto onCommand{[&eventLoop, &scheduler, &deadbandSummary, &batchSender,
+                       &ringSummary, &recorder, &archiver,
+                       &control](std::string const &command) {
+        if (command == "stop") {
+          eventLoop.stop();
+          return std::string("ok");
+        } else if (command == "status") {
+          return "ticks=" + std::to_string(scheduler.ticks()) +
+                 " missed=" + std::to_string(scheduler.missedDeadlines()) +
+                 (batchSender ? " " + batchSender->summary() : "") +
+                 ringSummary() +
+                 (recorder ? " rec " + recorder->summary() : "") +
+                 (archiver ? " archive " + archiver->summary() : "") +
+                 (control.hasLeases()
+                      ? " leases=" + std::to_string(control.leases())
+                      : "") +
+                 deadbandSummary();
+        }
+        return "unknown command '" + command + "'";
+      }};
+      if (!eventLoop.addControlSocket(commandlineArguments["control"],
+                                      onCommand)) {
+        std::cerr << "Failed to open control socket "
+                  << commandlineArguments["control"] << "." << std::endl;
+      }
+    }
+
+    std::unique_ptr<DeadlineScheduler> statisticsScheduler;
+    float statsPeriod{0.0f};
+    if (commandlineArguments["stats-period"].size() != 0 &&
+        !parseInRange(commandlineArguments["stats-period"], MIN_REPORT_PERIOD,
+                      static_cast<float>(MAX_REPORT_PERIOD), statsPeriod)) {
+      std::cerr << "Not supported stats period, must be " << MIN_REPORT_PERIOD
+                << " to " << MAX_REPORT_PERIOD << " s." << std::endl;
+      return 1;
+    }
+    float const STATS_PERIOD{statsPeriod};
+    if (STATS_PERIOD > 0.0f) {
+      statisticsScheduler.reset(new DeadlineScheduler(
+          DeadlineScheduler::periodFromFrequency(1.0f / STATS_PERIOD)));
+      uint32_t const SENDER_STAMP{state.configs.front().senderStamp};
+      auto publishStatistics{[&sendReport, &timingStatistics, &scheduler,
+                              &ringSummary, &deadbandSummary, SENDER_STAMP]() {
+        opendlv::device::adc::TimingSummary timingSummary;
+        timingSummary.description(
+            timingStatistics.summary(scheduler.missedDeadlines()) +
+            ringSummary() + deadbandSummary());
+        sendReport(timingSummary, cluon::time::now(), SENDER_STAMP);
+      }};
+      eventLoop.addTimer(*statisticsScheduler, publishStatistics);
+    }
+
+    // Optionally, health is published per window: per channel, a
+    // SignalStatusMessage with the last error code of the window as code, and
+    // for the device a SystemOperationState with code 0 when all channels
+    // read fine, 1 when some failed, and 2 when none gave a sample.
+    std::unique_ptr<DeadlineScheduler> healthScheduler;
+    float healthPeriod{0.0f};
+    if (commandlineArguments["health-period"].size() != 0 &&
+        !parseInRange(commandlineArguments["health-period"], MIN_REPORT_PERIOD,
+                      static_cast<float>(MAX_REPORT_PERIOD), healthPeriod)) {
+      std::cerr << "Not supported health period, must be " << MIN_REPORT_PERIOD
+                << " to " << MAX_REPORT_PERIOD << " s." << std::endl;
+      return 1;
+    }
+    float const HEALTH_PERIOD{healthPeriod};
+    if (HEALTH_PERIOD > 0.0f) {
+      healthScheduler.reset(new DeadlineScheduler(
+          DeadlineScheduler::periodFromFrequency(1.0f / HEALTH_PERIOD)));
+      int64_t healthWindowStart{DeadlineScheduler::now()};
+      uint64_t healthWindowTicks{0};
+      uint64_t healthWindowMissed{0};
+      auto publishHealth{[&sendReport, &state, &scheduler, &adcBuffer,
+                          healthWindowStart, healthWindowTicks,
+                          healthWindowMissed]() mutable {
+        int64_t const NOW{DeadlineScheduler::now()};
+        double const ELAPSED{static_cast<double>(NOW - healthWindowStart) *
+                             1.0e-9};
+        healthWindowStart = NOW;
+        cluon::data::TimeStamp const SAMPLE_TIME{cluon::time::now()};
+        size_t failing{0};
+        size_t dead{0};
+        for (size_t i{0}; i < state.configs.size(); i++) {
+          ChannelHealth &channel{state.health[i]};
+          bool const HAS_FAILED{channel.failures() > 0};
+          failing += HAS_FAILED ? 1 : 0;
+          dead += (0 == channel.samples()) ? 1 : 0;
+          char description[128];
+          std::snprintf(description, sizeof(description),
+                        "channel=%u rate=%.1f Hz error-rate=%.4f "
+                        "last-error=%d",
+                        static_cast<uint32_t>(state.configs[i].channel),
+                        static_cast<double>(channel.samples()) / ELAPSED,
+                        static_cast<double>(channel.errorRate()),
+                        channel.lastError());
+          opendlv::system::SignalStatusMessage signalStatus;
+          signalStatus.code(channel.statusCode());
+          signalStatus.description(description);
+          sendReport(signalStatus, SAMPLE_TIME, state.configs[i].senderStamp);
+          channel.clearWindow();
+        }
+        // Buffered capture has no timer, so only the per-channel rates are
+        // measured there.
+        uint64_t const TICKS{scheduler.ticks() - healthWindowTicks};
+        uint64_t const MISSED{scheduler.missedDeadlines() -
+                              healthWindowMissed};
+        healthWindowTicks = scheduler.ticks();
+        healthWindowMissed = scheduler.missedDeadlines();
+        char description[128];
+        std::snprintf(description, sizeof(description),
+                      "channels=%u failing=%u tick-rate=%.1f Hz missed=%u",
+                      static_cast<uint32_t>(state.configs.size()),
+                      static_cast<uint32_t>(failing),
+                      adcBuffer ? 0.0 : static_cast<double>(TICKS) / ELAPSED,
+                      static_cast<uint32_t>(MISSED));
+        opendlv::system::SystemOperationState operationState;
+        operationState.code((dead == state.configs.size()) ? 2
+                            : (failing > 0)                ? 1
+                                                           : 0);
+        operationState.description(description);
+        sendReport(operationState, SAMPLE_TIME,
+                   state.configs.front().senderStamp);
+      }};
+      eventLoop.addTimer(*healthScheduler, publishHealth);
+    }
+
+    // The page is built on the server thread from atomics only; state that
+    // runtime reconfiguration replaces, such as the deadband filters, is left
+    // out.
+    std::unique_ptr<MetricsServer> metricsServer;
+    if (metrics) {
+      auto metricsPage{[&metrics, &timingStatistics, &batchSender,
+                        &sampleRing, &recorder, &archiver]() {
+        std::string page{metrics->exposition()};
+        appendHistogram(page, "adc_tick_period_seconds",
+                        "Achieved time between sampling ticks.",
+                        timingStatistics.period);
+        appendHistogram(page, "adc_tick_jitter_seconds",
+                        "Deviation of the time between scheduled sampling "
+                        "ticks from the nominal period.",
+                        timingStatistics.jitter);
+        appendHistogram(page, "adc_read_duration_seconds",
+                        "Time spent reading the ADC per tick.",
+                        timingStatistics.readLatency);
+        appendHistogram(page, "adc_send_duration_seconds",
+                        "Time spent publishing the readings of a tick.",
+                        timingStatistics.sendLatency);
+        appendHistogram(page, "adc_alarm_latency_seconds",
+                        "Time from reading to sending an alarm.",
+                        timingStatistics.alarmLatency);
+        if (batchSender) {
+          appendCounter(page, "adc_sendmmsg_datagrams_total",
+                        "Datagrams sent with sendmmsg.",
+                        batchSender->datagrams());
+          appendCounter(page, "adc_sendmmsg_bytes_total",
+                        "Bytes sent with sendmmsg.", batchSender->bytes());
+          appendCounter(page, "adc_sendmmsg_calls_total",
+                        "sendmmsg system calls.", batchSender->syscalls());
+          appendCounter(page, "adc_sendmmsg_errors_total",
+                        "Datagrams that sendmmsg failed to send.",
+                        batchSender->errors());
+        }
+        if (sampleRing) {
+          appendGauge(page, "adc_ring_depth",
+                      "Samples queued for the publisher thread.",
+                      static_cast<double>(sampleRing->size()));
+          appendGauge(page, "adc_ring_max_depth",
+                      "Most samples ever queued for the publisher thread.",
+                      static_cast<double>(sampleRing->maxSize()));
+          appendGauge(page, "adc_ring_capacity",
+                      "Samples the publisher ring holds.",
+                      static_cast<double>(sampleRing->capacity()));
+          appendCounter(page, "adc_ring_dropped_total",
+                        "Samples dropped as the publisher ring was full.",
+                        sampleRing->dropped());
+        }
+        if (recorder) {
+          appendCounter(page, "adc_recorder_dropped_total",
+                        "Envelopes not recorded as the ring was full.",
+                        recorder->dropped());
+        }
+        if (archiver) {
+          appendCounter(page, "adc_archive_dropped_total",
+                        "Archive blocks not written as the ring was full.",
+                        archiver->dropped());
+        }
+        return page;
+      }};
+      metricsServer.reset(
+          new MetricsServer(METRICS_ADDRESS, METRICS_PORT, metricsPage));
+      if (!metricsServer->isRunning()) {
+        std::cerr << "Failed to serve metrics on " << METRICS_ADDRESS << ":"
+                  << METRICS_PORT << "." << std::endl;
+        return 1;
+      }
+    }
+
+    // Applied last, so that mlockall also covers the buffers set up above.
+    if (commandlineArguments.count("realtime") != 0) {
+      RealtimeProfile profile;
+      int64_t priority{profile.priority};
+      if (commandlineArguments["rt-priority"].size() != 0 &&
+          !parseInRange(commandlineArguments["rt-priority"],
+                        ::sched_get_priority_min(SCHED_FIFO),
+                        ::sched_get_priority_max(SCHED_FIFO), priority)) {
+        std::cerr << "Not supported real-time priority, must be "
+                  << ::sched_get_priority_min(SCHED_FIFO) << " to "
+                  << ::sched_get_priority_max(SCHED_FIFO) << "." << std::endl;
+        return 1;
+      }
+      profile.priority = static_cast<int32_t>(priority);
+      int64_t cpu{profile.cpu};
+      if (commandlineArguments["cpu"].size() != 0 &&
+          !parseInRange(commandlineArguments["cpu"], 0, CPU_SETSIZE - 1,
+                        cpu)) {
+        std::cerr << "Not supported CPU, must be 0 to " << CPU_SETSIZE - 1
+                  << "." << std::endl;
+        return 1;
+      }
+      profile.cpu = static_cast<int32_t>(cpu);
+      for (auto const &failure : applyRealtimeProfile(profile)) {
+        std::cerr << "Real-time profile not fully applied, " << failure << "."
+                  << std::endl;
+      }
+    }
+
+    eventLoop.run([&od4]() { return od4.isRunning(); });
+
+    if (metricsServer) {
+      metricsServer->stop();
+    }
+    if (publisherThread) {
+      publisherThread->stop();
+    }
+
+    for (size_t i{0}; i < state.batches.size(); i++) {
+      flushBatch(i);
+    }
+    for (size_t i{0}; i < state.statistics.size(); i++) {
+      flushSummary(i);
+    }
+    if (batchSender) {
+      batchSender->flush();
+      std::cerr << "Sent with sendmmsg: " << batchSender->summary()
+                << std::endl;
+    }
+    if (archiver) {
+      for (size_t i{0}; i < state.archiveBlocks.size(); i++) {
+        flushArchiveBlock(i);
+      }
+      archiver->stop();
+      std::cerr << "Archived to " << commandlineArguments["archive"] << ": "
+                << archiver->summary() << std::endl;
+    }
+    if (recorder) {
+      recorder->stop();
+      std::cerr << "Recorded to " << commandlineArguments["rec"] << ": "
+                << recorder->summary() << std::endl;
+    }
+
+    std::cerr << "Timing statistics: "
+              << timingStatistics.summary(scheduler.missedDeadlines())
+              << ringSummary() << deadbandSummary() << std::endl;
   }
   return retCode;
 }
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <utility>
+
+#include "publisher-thread.hpp"
+
+PublisherThread::PublisherThread(
+    SampleRing &ring, std::function<void(SampleRecord const &)> delegate,
+    std::function<void()> drainedDelegate) noexcept
+    : m_ring{ring},
+      m_delegate{delegate},
+      m_drainedDelegate{drainedDelegate},
+      m_eventFd{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)},
+      m_isStopped{false},
+      m_tasks{nullptr},
+      m_thread{} {
+  if (m_eventFd >= 0) {
+    m_thread = std::thread([this]() { run(); });
+  }
+}
+
+PublisherThread::~PublisherThread() noexcept {
+  stop();
+  runTasks(true);
+  if (m_eventFd >= 0) {
+    ::close(m_eventFd);
+  }
+}
+
+bool PublisherThread::isRunning() const noexcept {
+  return m_thread.joinable();
+}
+
+void PublisherThread::notify() noexcept {
+  uint64_t const ONE{1};
+  // A full counter means the publisher is awake anyway.
+  ssize_t const WRITTEN{::write(m_eventFd, &ONE, sizeof(ONE))};
+  (void)WRITTEN;
+}
+
+void PublisherThread::post(std::function<void()> task) noexcept {
+  Task *node{new Task};
+  node->function = std::move(task);
+  node->next = m_tasks.load(std::memory_order_relaxed);
+  while (!m_tasks.compare_exchange_weak(node->next, node,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+  }
+  notify();
+}
+
+void PublisherThread::stop() noexcept {
+  if (m_thread.joinable()) {
+    m_isStopped.store(true);
+    notify();
+    m_thread.join();
+  }
+}
+
+void PublisherThread::run() noexcept {
+  struct pollfd event {};
+  event.fd = m_eventFd;
+  event.events = POLLIN;
+  while (!m_isStopped.load()) {
+    // No timeout is needed: every tick notifies, and so does stop().
+    if (::poll(&event, 1, -1) > 0) {
+      uint64_t count{0};
+      ssize_t const READ{::read(m_eventFd, &count, sizeof(count))};
+      (void)READ;
+    }
+    drain();
+  }
+  drain();
+}
+
+void PublisherThread::drain() noexcept {
+  SampleRecord record;
+  while (m_ring.pop(record)) {
+    m_delegate(record);
+  }
+  runTasks(false);
+  m_drainedDelegate();
+}
+
+void PublisherThread::runTasks(bool isDiscarded) noexcept {
+  // The list is taken as a whole and holds the newest task first.
+  Task *task{m_tasks.exchange(nullptr, std::memory_order_acquire)};
+  Task *oldest{nullptr};
+  while (nullptr != task) {
+    Task *next{task->next};
+    task->next = oldest;
+    oldest = task;
+    task = next;
+  }
+  while (nullptr != oldest) {
+    Task *next{oldest->next};
+    if (!isDiscarded) {
+      oldest->function();
+    }
+    delete oldest;
+    oldest = next;
+  }
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PUBLISHER_THREAD_HPP
+#define PUBLISHER_THREAD_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "sample-ring.hpp"
+
+/**
+ * Thread draining a SampleRing into a delegate, so that encoding and sending
+ * cannot delay the sampling thread. The sampling thread calls notify() once
+ * per tick after pushing its records; this costs one non-blocking eventfd
+ * write, and in between the thread sleeps on the eventfd. Each time the ring
+ * has been drained, the drained delegate is called, also when a tick pushed
+ * nothing, e.g. to flush queued datagrams and batches that grew too old.
+ * Other threads can post() a task, such as sending a report through the
+ * sender this thread owns; tasks are pushed onto a lock-free list and run in
+ * the order they were posted, after the ring and before the drained
+ * delegate. On stop(), the remaining records and tasks are drained before
+ * the thread is joined.
+ */
+class PublisherThread {
+ private:
+  PublisherThread(PublisherThread const &) = delete;
+  PublisherThread(PublisherThread &&) = delete;
+  PublisherThread &operator=(PublisherThread const &) = delete;
+  PublisherThread &operator=(PublisherThread &&) = delete;
+
+ public:
+  PublisherThread(SampleRing &ring,
+                  std::function<void(SampleRecord const &)> delegate,
+                  std::function<void()> drainedDelegate) noexcept;
+  ~PublisherThread() noexcept;
+
+ public:
+  bool isRunning() const noexcept;
+  void notify() noexcept;
+  void post(std::function<void()> task) noexcept;
+  void stop() noexcept;
+
+ private:
+  struct Task {
+    std::function<void()> function{};
+    Task *next{nullptr};
+  };
+
+ private:
+  void run() noexcept;
+  void drain() noexcept;
+  void runTasks(bool isDiscarded) noexcept;
+
+ private:
+  SampleRing &m_ring;
+  std::function<void(SampleRecord const &)> m_delegate;
+  std::function<void()> m_drainedDelegate;
+  int32_t m_eventFd;
+  std::atomic<bool> m_isStopped;
+  std::atomic<Task *> m_tasks;
+  std::thread m_thread;
+};
+
+#endif
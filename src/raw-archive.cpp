@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <endian.h>
+
+#include <cstring>
+
+#include "raw-archive.hpp"
+
+uint16_t const ArchiveBlockEncoder::MAX_SAMPLES;
+
+namespace {
+char const MAGIC[4]{'A', 'D', 'C', 'A'};
+char const ALARM_MAGIC[4]{'A', 'D', 'C', 'E'};
+// A zig-zag encoded 32-bit difference takes at most five varint bytes.
+size_t const MAX_VARINT_SIZE{5};
+
+template <typename T>
+void store(char *data, T value) noexcept {
+  std::memcpy(data, &value, sizeof(value));
+}
+
+template <typename T>
+T load(char const *data) noexcept {
+  T value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint32_t floatBits(float value) noexcept {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+float bitsFloat(uint32_t bits) noexcept {
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+}  // namespace
+
+size_t archiveHeaderSize(char const *data, size_t size) noexcept {
+  if (size < 5 || 0 != std::memcmp(data, MAGIC, 4)) {
+    return 0;
+  }
+  uint8_t const VERSION{static_cast<uint8_t>(data[4])};
+  return (ARCHIVE_VERSION == VERSION) ? ARCHIVE_HEADER_SIZE
+         : (1 == VERSION)             ? ARCHIVE_V1_HEADER_SIZE
+                                      : 0;
+}
+
+bool parseArchiveBlockHeader(char const *data, size_t size,
+                             ArchiveBlockHeader &header) noexcept {
+  size_t const HEADER_SIZE{archiveHeaderSize(data, size)};
+  if (0 == HEADER_SIZE || size < HEADER_SIZE) {
+    return false;
+  }
+  header.channel = static_cast<uint8_t>(data[5]);
+  header.sampleCount = le16toh(load<uint16_t>(data + 6));
+  header.payloadSize = le32toh(load<uint32_t>(data + 8));
+  header.baseTimeStamp =
+      static_cast<int64_t>(le64toh(load<uint64_t>(data + 12)));
+  // Version 1 had a 4-byte sample period, moving the later fields up.
+  size_t const SHIFT{(ARCHIVE_HEADER_SIZE == HEADER_SIZE) ? 0u : 4u};
+  header.samplePeriod =
+      (0 == SHIFT)
+          ? static_cast<int64_t>(le64toh(load<uint64_t>(data + 20)))
+          : static_cast<int64_t>(le32toh(load<uint32_t>(data + 20)));
+  header.senderStamp = le32toh(load<uint32_t>(data + 28 - SHIFT));
+  header.conversion2Volt =
+      bitsFloat(le32toh(load<uint32_t>(data + 32 - SHIFT)));
+  header.offset = bitsFloat(le32toh(load<uint32_t>(data + 36 - SHIFT)));
+  return header.payloadSize <= header.sampleCount * MAX_VARINT_SIZE;
+}
+
+bool decodeArchivePayload(char const *payload, size_t size,
+                          uint16_t sampleCount, int32_t *raw) noexcept {
+  uint8_t const *p{reinterpret_cast<uint8_t const *>(payload)};
+  uint8_t const *const END{p + size};
+  uint32_t previous{0};
+  for (uint16_t i{0}; i < sampleCount; i++) {
+    uint32_t zigzag{0};
+    uint32_t shift{0};
+    do {
+      if (p == END || shift > 28) {
+        return false;
+      }
+      zigzag |= static_cast<uint32_t>(*p & 0x7f) << shift;
+      shift += 7;
+    } while (*p++ & 0x80);
+    uint32_t const DELTA{(zigzag >> 1) ^ (0u - (zigzag & 1u))};
+    previous += DELTA;
+    raw[i] = static_cast<int32_t>(previous);
+  }
+  return p == END;
+}
+
+AdcChannelConfig toChannelConfig(ArchiveBlockHeader const &header) noexcept {
+  AdcChannelConfig config;
+  config.channel = header.channel;
+  config.senderStamp = header.senderStamp;
+  config.conversion2Volt = header.conversion2Volt;
+  config.offset = header.offset;
+  return config;
+}
+
+bool isArchiveAlarm(char const *data, size_t size) noexcept {
+  return size >= 5 && 0 == std::memcmp(data, ALARM_MAGIC, 4) &&
+         ARCHIVE_ALARM_VERSION == static_cast<uint8_t>(data[4]);
+}
+
+void encodeArchiveAlarm(ArchiveAlarm const &alarm, char *data) noexcept {
+  std::memcpy(data, ALARM_MAGIC, 4);
+  data[4] = static_cast<char>(ARCHIVE_ALARM_VERSION);
+  data[5] = static_cast<char>(alarm.channel);
+  data[6] = static_cast<char>(alarm.isActive ? 1 : 0);
+  data[7] = 0;
+  store(data + 8, htole64(static_cast<uint64_t>(alarm.timeStamp)));
+  store(data + 16, htole64(static_cast<uint64_t>(alarm.since)));
+  store(data + 24, htole32(alarm.senderStamp));
+  store(data + 28, htole32(floatBits(alarm.voltage)));
+  store(data + 32, htole32(floatBits(alarm.threshold)));
+  store(data + 36, htole32(floatBits(alarm.release)));
+}
+
+bool parseArchiveAlarm(char const *data, size_t size,
+                       ArchiveAlarm &alarm) noexcept {
+  if (size < ARCHIVE_ALARM_SIZE || !isArchiveAlarm(data, size)) {
+    return false;
+  }
+  alarm.channel = static_cast<uint8_t>(data[5]);
+  alarm.isActive = (0 != data[6]);
+  alarm.timeStamp = static_cast<int64_t>(le64toh(load<uint64_t>(data + 8)));
+  alarm.since = static_cast<int64_t>(le64toh(load<uint64_t>(data + 16)));
+  alarm.senderStamp = le32toh(load<uint32_t>(data + 24));
+  alarm.voltage = bitsFloat(le32toh(load<uint32_t>(data + 28)));
+  alarm.threshold = bitsFloat(le32toh(load<uint32_t>(data + 32)));
+  alarm.release = bitsFloat(le32toh(load<uint32_t>(data + 36)));
+  return true;
+}
+
+ArchiveBlockEncoder::ArchiveBlockEncoder(AdcChannelConfig const &config,
+                                         uint16_t maxSamples,
+                                         int64_t periodInNanoseconds) noexcept
+    : m_config(config),
+      m_maxSamples{(maxSamples > 0) ? maxSamples : MAX_SAMPLES},
+      m_period{periodInNanoseconds},
+      m_baseTimeStamp{0},
+      m_sampleCount{0},
+      m_previous{0},
+      m_block(ARCHIVE_HEADER_SIZE) {
+  m_block.reserve(ARCHIVE_HEADER_SIZE + m_maxSamples * MAX_VARINT_SIZE);
+}
+
+bool ArchiveBlockEncoder::add(int32_t raw,
+                              int64_t sampleTimeInMicroseconds) noexcept {
+  if (isFull()) {
+    return false;
+  }
+  if (0 == m_sampleCount) {
+    m_baseTimeStamp = sampleTimeInMicroseconds;
+  } else {
+    int64_t const EXPECTED{m_baseTimeStamp + m_sampleCount * m_period / 1000};
+    int64_t const DEVIATION{sampleTimeInMicroseconds - EXPECTED};
+    int64_t const TOLERANCE{m_period / 2000};
+    if (DEVIATION > TOLERANCE || DEVIATION < -TOLERANCE) {
+      return false;
+    }
+  }
+  uint32_t const DELTA{static_cast<uint32_t>(raw) -
+                       static_cast<uint32_t>(m_previous)};
+  uint32_t zigzag{(DELTA << 1) ^ (0u - (DELTA >> 31))};
+  while (zigzag >= 0x80) {
+    m_block.push_back(static_cast<char>((zigzag & 0x7f) | 0x80));
+    zigzag >>= 7;
+  }
+  m_block.push_back(static_cast<char>(zigzag));
+  m_previous = raw;
+  m_sampleCount++;
+  return true;
+}
+
+bool ArchiveBlockEncoder::isEmpty() const noexcept {
+  return 0 == m_sampleCount;
+}
+
+bool ArchiveBlockEncoder::isFull() const noexcept {
+  return m_sampleCount >= m_maxSamples;
+}
+
+char const *ArchiveBlockEncoder::data() noexcept {
+  char *header{m_block.data()};
+  std::memcpy(header, MAGIC, 4);
+  header[4] = static_cast<char>(ARCHIVE_VERSION);
+  header[5] = static_cast<char>(m_config.channel);
+  store(header + 6, htole16(m_sampleCount));
+  store(header + 8,
+        htole32(static_cast<uint32_t>(m_block.size() - ARCHIVE_HEADER_SIZE)));
+  store(header + 12, htole64(static_cast<uint64_t>(m_baseTimeStamp)));
+  store(header + 20, htole64(static_cast<uint64_t>(m_period)));
+  store(header + 28, htole32(m_config.senderStamp));
+  store(header + 32, htole32(floatBits(m_config.conversion2Volt)));
+  store(header + 36, htole32(floatBits(m_config.offset)));
+  return header;
+}
+
+size_t ArchiveBlockEncoder::size() const noexcept {
+  return m_block.size();
+}
+
+void ArchiveBlockEncoder::clear() noexcept {
+  m_block.resize(ARCHIVE_HEADER_SIZE);
+  m_sampleCount = 0;
+  m_previous = 0;
+}
+
+ArchiveDecoder::ArchiveDecoder(std::istream &in) noexcept
+    : m_in(in),
+      m_isCorrupt{false},
+      m_isAlarm{false},
+      m_alarm{},
+      m_header{},
+      m_payload{},
+      m_raw{} {}
+
+bool ArchiveDecoder::next() noexcept {
+  // The shorter header of version 1 is read first; it tells the version, or
+  // that an alarm record follows.
+  char header[ARCHIVE_HEADER_SIZE];
+  m_isAlarm = false;
+  if (!m_in.read(header, ARCHIVE_V1_HEADER_SIZE)) {
+    // Ending in the middle of a header means a truncated archive.
+    m_isCorrupt = m_isCorrupt || (m_in.gcount() > 0);
+    return false;
+  }
+  if (isArchiveAlarm(header, ARCHIVE_V1_HEADER_SIZE)) {
+    if (!m_in.read(header + ARCHIVE_V1_HEADER_SIZE,
+                   static_cast<std::streamsize>(ARCHIVE_ALARM_SIZE -
+                                                ARCHIVE_V1_HEADER_SIZE)) ||
+        !parseArchiveAlarm(header, ARCHIVE_ALARM_SIZE, m_alarm)) {
+      m_isCorrupt = true;
+      return false;
+    }
+    m_isAlarm = true;
+    m_raw.clear();
+    return true;
+  }
+  size_t const HEADER_SIZE{archiveHeaderSize(header, ARCHIVE_V1_HEADER_SIZE)};
+  if (HEADER_SIZE > ARCHIVE_V1_HEADER_SIZE &&
+      !m_in.read(header + ARCHIVE_V1_HEADER_SIZE,
+                 static_cast<std::streamsize>(HEADER_SIZE -
+                                              ARCHIVE_V1_HEADER_SIZE))) {
+    m_isCorrupt = true;
+    return false;
+  }
+  if (!parseArchiveBlockHeader(header, HEADER_SIZE, m_header)) {
+    m_isCorrupt = true;
+    return false;
+  }
+  m_payload.resize(m_header.payloadSize);
+  m_raw.resize(m_header.sampleCount);
+  if (!m_in.read(m_payload.data(),
+                 static_cast<std::streamsize>(m_payload.size())) ||
+      !decodeArchivePayload(m_payload.data(), m_payload.size(),
+                            m_header.sampleCount, m_raw.data())) {
+    m_isCorrupt = true;
+    return false;
+  }
+  return true;
+}
+
+bool ArchiveDecoder::isCorrupt() const noexcept {
+  return m_isCorrupt;
+}
+
+ArchiveBlockHeader const &ArchiveDecoder::header() const noexcept {
+  return m_header;
+}
+
+bool ArchiveDecoder::isAlarm() const noexcept {
+  return m_isAlarm;
+}
+
+std::vector<int32_t> const &ArchiveDecoder::raw() const noexcept {
+  return m_raw;
+}
+
+ArchiveAlarm const &ArchiveDecoder::alarm() const noexcept {
+  return m_alarm;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RAW_ARCHIVE_HPP
+#define RAW_ARCHIVE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+#include "adc-sampler.hpp"
+
+/**
+ * Compact archive of raw ADC codes. An archive is a sequence of blocks, each
+ * covering evenly spaced samples of one channel. All fields are
+ * little-endian:
+ *
+ *   offset size field
+ *        0    4 magic "ADCA"
+ *        4    1 version (2)
+ *        5    1 channel
+ *        6    2 sample count
+ *        8    4 payload size in bytes
+ *       12    8 time stamp of the first sample in microseconds
+ *       20    8 sample period in nanoseconds
+ *       28    4 sender stamp
+ *       32    4 conversion to volts at full scale (float)
+ *       36    4 offset in volts (float)
+ *       40      payload: per sample, the difference to the previous raw
+ *               code (0 before the first) as zig-zag varint
+ *
+ * With 12-bit codes that change slowly, a sample takes one or two bytes
+ * instead of a full VoltageReading envelope. Blocks of version 1, whose
+ * sample period took 4 bytes and overflowed below about 0.23 Hz, are still
+ * read; their header ends 4 bytes earlier.
+ *
+ * Undervoltage alarm transitions are interleaved as records of their own.
+ * They are written when they happen, so they precede the block holding the
+ * sample that caused them:
+ *
+ *   offset size field
+ *        0    4 magic "ADCE"
+ *        4    1 version (1)
+ *        5    1 channel
+ *        6    1 1 if the alarm was raised, 0 if it was cleared
+ *        7    1 reserved (0)
+ *        8    8 time stamp of the sample in microseconds
+ *       16    8 time stamp since when the alarm is active, in microseconds
+ *       24    4 sender stamp
+ *       28    4 voltage (float)
+ *       32    4 threshold (float)
+ *       36    4 release (float)
+ */
+size_t const ARCHIVE_HEADER_SIZE{40};
+size_t const ARCHIVE_V1_HEADER_SIZE{36};
+uint8_t const ARCHIVE_VERSION{2};
+size_t const ARCHIVE_ALARM_SIZE{40};
+uint8_t const ARCHIVE_ALARM_VERSION{1};
+
+struct ArchiveBlockHeader {
+  uint8_t channel{0};
+  uint16_t sampleCount{0};
+  uint32_t payloadSize{0};
+  int64_t baseTimeStamp{0};
+  int64_t samplePeriod{0};
+  uint32_t senderStamp{0};
+  float conversion2Volt{0.0f};
+  float offset{0.0f};
+};
+
+struct ArchiveAlarm {
+  uint8_t channel{0};
+  bool isActive{false};
+  int64_t timeStamp{0};
+  int64_t since{0};
+  uint32_t senderStamp{0};
+  float voltage{0.0f};
+  float threshold{0.0f};
+  float release{0.0f};
+};
+
+size_t archiveHeaderSize(char const *data, size_t size) noexcept;
+bool parseArchiveBlockHeader(char const *data, size_t size,
+                             ArchiveBlockHeader &header) noexcept;
+bool decodeArchivePayload(char const *payload, size_t size,
+                          uint16_t sampleCount, int32_t *raw) noexcept;
+AdcChannelConfig toChannelConfig(ArchiveBlockHeader const &header) noexcept;
+bool isArchiveAlarm(char const *data, size_t size) noexcept;
+void encodeArchiveAlarm(ArchiveAlarm const &alarm, char *data) noexcept;
+bool parseArchiveAlarm(char const *data, size_t size,
+                       ArchiveAlarm &alarm) noexcept;
+
+/**
+ * Builds one archive block at a time for one channel. A sample that does
+ * not fall on the expected time of the next slot cannot extend the block,
+ * just like for VoltageBatch; add() then returns false and the caller is
+ * expected to write the block out and clear it first.
+ */
+class ArchiveBlockEncoder {
+ private:
+  ArchiveBlockEncoder(ArchiveBlockEncoder const &) = delete;
+  ArchiveBlockEncoder &operator=(ArchiveBlockEncoder const &) = delete;
+  ArchiveBlockEncoder &operator=(ArchiveBlockEncoder &&) = delete;
+
+ public:
+  static uint16_t const MAX_SAMPLES{65535};
+
+ public:
+  ArchiveBlockEncoder(AdcChannelConfig const &config, uint16_t maxSamples,
+                      int64_t periodInNanoseconds) noexcept;
+  ArchiveBlockEncoder(ArchiveBlockEncoder &&) = default;
+  ~ArchiveBlockEncoder() = default;
+
+ public:
+  bool add(int32_t raw, int64_t sampleTimeInMicroseconds) noexcept;
+  bool isEmpty() const noexcept;
+  bool isFull() const noexcept;
+  char const *data() noexcept;
+  size_t size() const noexcept;
+  void clear() noexcept;
+
+ private:
+  AdcChannelConfig m_config;
+  uint16_t m_maxSamples;
+  int64_t m_period;
+  int64_t m_baseTimeStamp;
+  uint16_t m_sampleCount;
+  int32_t m_previous;
+  std::vector<char> m_block;
+};
+
+/**
+ * Reads the blocks of an archive from a stream, one block or alarm record per
+ * call, into reused buffers. isAlarm() tells which of the two was read.
+ */
+class ArchiveDecoder {
+ private:
+  ArchiveDecoder(ArchiveDecoder const &) = delete;
+  ArchiveDecoder(ArchiveDecoder &&) = delete;
+  ArchiveDecoder &operator=(ArchiveDecoder const &) = delete;
+  ArchiveDecoder &operator=(ArchiveDecoder &&) = delete;
+
+ public:
+  explicit ArchiveDecoder(std::istream &in) noexcept;
+  ~ArchiveDecoder() = default;
+
+ public:
+  bool next() noexcept;
+  bool isCorrupt() const noexcept;
+  bool isAlarm() const noexcept;
+  ArchiveBlockHeader const &header() const noexcept;
+  std::vector<int32_t> const &raw() const noexcept;
+  ArchiveAlarm const &alarm() const noexcept;
+
+ private:
+  std::istream &m_in;
+  bool m_isCorrupt;
+  bool m_isAlarm;
+  ArchiveAlarm m_alarm;
+  ArchiveBlockHeader m_header;
+  std::vector<char> m_payload;
+  std::vector<int32_t> m_raw;
+};
+
+#endif
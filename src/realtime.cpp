@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <alloca.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "realtime.hpp"
+
+// Touches every page of a stack area of the given size, so that later ticks
+// never take a page fault on the stack.
+static void __attribute__((noinline)) prefaultStack(size_t size) noexcept {
+  volatile char *stack{static_cast<volatile char *>(::alloca(size))};
+  for (size_t i{0}; i < size; i += 4096) {
+    stack[i] = 0;
+  }
+}
+
+std::vector<std::string> applyRealtimeProfile(
+    RealtimeProfile const &profile) noexcept {
+  std::vector<std::string> failures;
+
+  if (0 != ::mlockall(MCL_CURRENT | MCL_FUTURE)) {
+    failures.push_back("mlockall: " + std::string(std::strerror(errno)));
+  }
+  prefaultStack(profile.stackSize);
+
+  if (profile.cpu >= 0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(profile.cpu, &cpus);
+    int32_t const RETVAL{
+        ::pthread_setaffinity_np(::pthread_self(), sizeof(cpus), &cpus)};
+    if (0 != RETVAL) {
+      failures.push_back("affinity to CPU " + std::to_string(profile.cpu) +
+                         ": " + std::strerror(RETVAL));
+    }
+  }
+
+  struct sched_param param {};
+  int32_t const MIN{::sched_get_priority_min(SCHED_FIFO)};
+  int32_t const MAX{::sched_get_priority_max(SCHED_FIFO)};
+  param.sched_priority = (profile.priority < MIN)
+                             ? MIN
+                             : ((profile.priority > MAX) ? MAX : profile.priority);
+  int32_t const RETVAL{
+      ::pthread_setschedparam(::pthread_self(), SCHED_FIFO, &param)};
+  if (0 != RETVAL) {
+    failures.push_back("SCHED_FIFO priority " +
+                       std::to_string(param.sched_priority) + ": " +
+                       std::strerror(RETVAL));
+  }
+  return failures;
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REALTIME_HPP
+#define REALTIME_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Execution profile for the sampling thread: SCHED_FIFO priority, CPU to pin
+ * to (negative for no pinning) and how much stack to pre-fault.
+ */
+struct RealtimeProfile {
+  int32_t priority{50};
+  int32_t cpu{-1};
+  size_t stackSize{256 * 1024};
+};
+
+/**
+ * Applies the profile to the calling thread: locks all current and future
+ * memory, pre-faults the stack, pins the thread and switches it to
+ * SCHED_FIFO. Each step is attempted independently; the returned list
+ * describes the steps that could not be applied, e.g. for lack of
+ * CAP_SYS_NICE or CAP_IPC_LOCK.
+ */
+std::vector<std::string> applyRealtimeProfile(
+    RealtimeProfile const &profile) noexcept;
+
+#endif
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include "deadline-scheduler.hpp"
+#include "recorder.hpp"
+
+bool parseFsyncPolicy(std::string const &name, FsyncPolicy &policy) noexcept {
+  if (name == "none") {
+    policy = FsyncPolicy::None;
+  } else if (name == "rotate") {
+    policy = FsyncPolicy::Rotate;
+  } else if (name == "write") {
+    policy = FsyncPolicy::Write;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+Recorder::Recorder(std::string const &path, size_t ringSize, uint64_t maxBytes,
+                   int64_t maxAgeInNanoseconds, FsyncPolicy fsyncPolicy,
+                   int64_t writeIntervalInNanoseconds,
+                   size_t producers) noexcept
+    : m_path{path},
+      m_extension{},
+      m_isRotating{maxBytes > 0 || maxAgeInNanoseconds > 0},
+      m_maxBytes{maxBytes},
+      m_maxAge{maxAgeInNanoseconds},
+      m_fsyncPolicy{fsyncPolicy},
+      m_writeInterval{writeIntervalInNanoseconds},
+      m_ringSize{(ringSize > 0) ? ringSize : 1},
+      m_producers{(producers > 0) ? producers : 1},
+      m_rings{new Ring[m_producers]},
+      m_chunk(m_ringSize),
+      m_fd{-1},
+      m_fileIndex{0},
+      m_fileBytes{0},
+      m_fileOpened{0},
+      m_recorded{0},
+      m_dropped{0},
+      m_files{0},
+      m_writeErrors{0},
+      m_isStopped{false},
+      m_thread{} {
+  for (size_t i{0}; i < m_producers; i++) {
+    m_rings[i].data.reset(new char[m_ringSize]);
+  }
+  size_t const DOT{m_path.find_last_of('.')};
+  if (m_isRotating && std::string::npos != DOT &&
+      (std::string::npos == m_path.find('/', DOT))) {
+    m_extension = m_path.substr(DOT);
+    m_path.erase(DOT);
+  }
+  if (openFile()) {
+    m_thread = std::thread([this]() { run(); });
+  }
+}
+
+Recorder::~Recorder() noexcept {
+  stop();
+}
+
+bool Recorder::isOpen() const noexcept {
+  return m_thread.joinable();
+}
+
+bool Recorder::record(char const *data, size_t size,
+                      size_t producer) noexcept {
+  // Each record is preceded by its length in the ring, so that the writer
+  // knows where files can be split.
+  Ring &ring{m_rings[(producer < m_producers) ? producer : 0]};
+  uint32_t const LENGTH{static_cast<uint32_t>(size)};
+  uint64_t const HEAD{ring.head.load(std::memory_order_relaxed)};
+  uint64_t const TAIL{ring.tail.load(std::memory_order_acquire)};
+  if (sizeof(LENGTH) + size > m_ringSize - static_cast<size_t>(HEAD - TAIL)) {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  copyIn(ring, HEAD, reinterpret_cast<char const *>(&LENGTH), sizeof(LENGTH));
+  copyIn(ring, HEAD + sizeof(LENGTH), data, size);
+  ring.head.store(HEAD + sizeof(LENGTH) + size, std::memory_order_release);
+  return true;
+}
+
+void Recorder::copyIn(Ring &ring, uint64_t position, char const *data,
+                      size_t size) noexcept {
+  size_t const OFFSET{static_cast<size_t>(position % m_ringSize)};
+  size_t const FIRST{std::min(size, m_ringSize - OFFSET)};
+  std::memcpy(ring.data.get() + OFFSET, data, FIRST);
+  std::memcpy(ring.data.get(), data + FIRST, size - FIRST);
+}
+
+void Recorder::stop() noexcept {
+  if (m_thread.joinable()) {
+    m_isStopped.store(true);
+    m_thread.join();
+  }
+}
+
+uint64_t Recorder::recorded() const noexcept {
+  return m_recorded.load(std::memory_order_relaxed);
+}
+
+uint64_t Recorder::dropped() const noexcept {
+  return m_dropped.load(std::memory_order_relaxed);
+}
+
+uint64_t Recorder::files() const noexcept {
+  return m_files.load(std::memory_order_relaxed);
+}
+
+std::string Recorder::summary() const noexcept {
+  return "bytes=" + std::to_string(recorded()) +
+         " dropped=" + std::to_string(dropped()) +
+         " files=" + std::to_string(files()) +
+         " errors=" + std::to_string(m_writeErrors.load());
+}
+
+void Recorder::run() noexcept {
+  while (!m_isStopped.load()) {
+    std::this_thread::sleep_for(std::chrono::nanoseconds(m_writeInterval));
+    writeOut();
+  }
+  writeOut();
+  closeFile();
+}
+
+void Recorder::writeOut() noexcept {
+  for (size_t i{0}; i < m_producers; i++) {
+    writeOut(m_rings[i]);
+  }
+}
+
+void Recorder::writeOut(Ring &ring) noexcept {
+  uint64_t const TAIL{ring.tail.load(std::memory_order_relaxed)};
+  uint64_t const HEAD{ring.head.load(std::memory_order_acquire)};
+  size_t const SIZE{static_cast<size_t>(HEAD - TAIL)};
+  if (0 == SIZE) {
+    return;
+  }
+  // Copied out in one piece, so that the ring is freed right away and
+  // records can be walked without caring about wrap-around.
+  size_t const OFFSET{static_cast<size_t>(TAIL % m_ringSize)};
+  size_t const FIRST{std::min(SIZE, m_ringSize - OFFSET)};
+  std::memcpy(m_chunk.data(), ring.data.get() + OFFSET, FIRST);
+  std::memcpy(m_chunk.data() + FIRST, ring.data.get(), SIZE - FIRST);
+  ring.tail.store(HEAD, std::memory_order_release);
+
+  // The length prefixes are squeezed out in place while walking the
+  // records; [start, end) is what goes into the current file.
+  char *data{m_chunk.data()};
+  size_t start{0};
+  size_t end{0};
+  size_t position{0};
+  uint32_t length{0};
+  while (position + sizeof(length) <= SIZE) {
+    std::memcpy(&length, data + position, sizeof(length));
+    position += sizeof(length);
+    uint64_t const FILE_BYTES{m_fileBytes + (end - start)};
+    bool const IS_TOO_LARGE{m_maxBytes > 0 && FILE_BYTES > 0 &&
+                            FILE_BYTES + length > m_maxBytes};
+    bool const IS_TOO_OLD{m_maxAge > 0 && FILE_BYTES > 0 &&
+                          DeadlineScheduler::now() - m_fileOpened >= m_maxAge};
+    if (IS_TOO_LARGE || IS_TOO_OLD) {
+      writeAll(data + start, end - start);
+      closeFile();
+      openFile();
+      start = end;
+    }
+    std::memmove(data + end, data + position, length);
+    end += length;
+    position += length;
+  }
+  writeAll(data + start, end - start);
+  if (FsyncPolicy::Write == m_fsyncPolicy && m_fd >= 0) {
+    ::fdatasync(m_fd);
+  }
+}
+
+bool Recorder::openFile() noexcept {
+  if (!m_isRotating) {
+    m_fd = ::open(m_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                  0644);
+  } else {
+    do {
+      std::string const NAME{m_path + "-" + std::to_string(m_fileIndex++) +
+                             m_extension};
+      m_fd = ::open(NAME.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                    0644);
+    } while (m_fd < 0 && EEXIST == errno);
+  }
+  m_fileBytes = 0;
+  m_fileOpened = DeadlineScheduler::now();
+  if (m_fd >= 0) {
+    m_files.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void Recorder::closeFile() noexcept {
+  if (m_fd >= 0) {
+    if (FsyncPolicy::None != m_fsyncPolicy) {
+      ::fsync(m_fd);
+    }
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
+
+bool Recorder::writeAll(char const *data, size_t size) noexcept {
+  if (0 == size) {
+    return true;
+  }
+  if (m_fd < 0) {
+    m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  size_t written{0};
+  while (written < size) {
+    ssize_t const N{::write(m_fd, data + written, size - written)};
+    if (N < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    written += static_cast<size_t>(N);
+  }
+  m_fileBytes += size;
+  m_recorded.fetch_add(size, std::memory_order_relaxed);
+  return true;
+}
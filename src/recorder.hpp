@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RECORDER_HPP
+#define RECORDER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class FsyncPolicy { None, Rotate, Write };
+
+bool parseFsyncPolicy(std::string const &name, FsyncPolicy &policy) noexcept;
+
+/**
+ * Appends records, such as serialized envelopes for .rec files that cluon
+ * tools can replay, to files. record() only copies into a lock-free byte
+ * ring and never makes a syscall, so it can be called from the sampling
+ * thread; a background thread writes the ring out in large chunks every
+ * write interval. When the ring is full, records are dropped and counted.
+ * Each ring has a single producer. Threads that record into the same files,
+ * e.g. alarms from the sampling thread and readings from a publisher thread,
+ * each get a producer index with a ring of their own, and the background
+ * thread drains the rings one after the other.
+ *
+ * Without limits, everything goes into the given path. With a size or age
+ * limit, files are named <stem>-<n><extension> with n counting up from the
+ * first unused number, and a new file is started between two records once a
+ * limit is reached.
+ */
+class Recorder {
+ private:
+  Recorder(Recorder const &) = delete;
+  Recorder(Recorder &&) = delete;
+  Recorder &operator=(Recorder const &) = delete;
+  Recorder &operator=(Recorder &&) = delete;
+
+ public:
+  Recorder(std::string const &path, size_t ringSize, uint64_t maxBytes,
+           int64_t maxAgeInNanoseconds, FsyncPolicy fsyncPolicy,
+           int64_t writeIntervalInNanoseconds, size_t producers = 1) noexcept;
+  ~Recorder() noexcept;
+
+ public:
+  bool isOpen() const noexcept;
+  bool record(char const *data, size_t size, size_t producer = 0) noexcept;
+  void stop() noexcept;
+  uint64_t recorded() const noexcept;
+  uint64_t dropped() const noexcept;
+  uint64_t files() const noexcept;
+  std::string summary() const noexcept;
+
+ private:
+  // One single-producer ring of length-prefixed records.
+  struct Ring {
+    std::unique_ptr<char[]> data{};
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};
+  };
+
+ private:
+  void copyIn(Ring &ring, uint64_t position, char const *data,
+              size_t size) noexcept;
+  void run() noexcept;
+  void writeOut() noexcept;
+  void writeOut(Ring &ring) noexcept;
+  bool openFile() noexcept;
+  void closeFile() noexcept;
+  bool writeAll(char const *data, size_t size) noexcept;
+
+ private:
+  std::string m_path;
+  std::string m_extension;
+  bool m_isRotating;
+  uint64_t m_maxBytes;
+  int64_t m_maxAge;
+  FsyncPolicy m_fsyncPolicy;
+  int64_t m_writeInterval;
+  size_t m_ringSize;
+  size_t m_producers;
+  std::unique_ptr<Ring[]> m_rings;
+  std::vector<char> m_chunk;
+  int32_t m_fd;
+  uint32_t m_fileIndex;
+  uint64_t m_fileBytes;
+  int64_t m_fileOpened;
+  std::atomic<uint64_t> m_recorded;
+  std::atomic<uint64_t> m_dropped;
+  std::atomic<uint64_t> m_files;
+  std::atomic<uint64_t> m_writeErrors;
+  std::atomic<bool> m_isStopped;
+  std::thread m_thread;
+};
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "sample-ring.hpp"
+
+bool parseOverflowPolicy(std::string const &name,
+                         OverflowPolicy &policy) noexcept {
+  if (name == "drop-oldest") {
+    policy = OverflowPolicy::DropOldest;
+  } else if (name == "drop-newest") {
+    policy = OverflowPolicy::DropNewest;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+size_t const SampleRing::MAX_CAPACITY;
+
+SampleRing::SampleRing(size_t capacity, OverflowPolicy policy) noexcept
+    : m_capacity{(capacity > 0) ? capacity : 1},
+      m_policy{policy},
+      m_slots{new Slot[m_capacity]},
+      m_padding0{},
+      m_head{0},
+      m_padding1{},
+      m_tail{0},
+      m_padding2{},
+      m_maxSize{0},
+      m_pushed{0},
+      m_dropped{0} {}
+
+bool SampleRing::push(SampleRecord const &record) noexcept {
+  uint64_t const HEAD{m_head.load(std::memory_order_relaxed)};
+  uint64_t tail{m_tail.load(std::memory_order_acquire)};
+  if (HEAD - tail >= m_capacity) {
+    if (OverflowPolicy::DropNewest == m_policy) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    // The read index is advanced before the slot is overwritten; if the
+    // consumer claimed the record first, there is room anyway.
+    if (m_tail.compare_exchange_strong(tail, tail + 1,
+                                       std::memory_order_acq_rel)) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  uint32_t voltageBits{0};
+  std::memcpy(&voltageBits, &record.voltage, sizeof(voltageBits));
+  Slot &slot{m_slots[HEAD % m_capacity]};
+  slot.sampleTime.store(static_cast<uint64_t>(record.sampleTime),
+                        std::memory_order_relaxed);
+  slot.value.store((static_cast<uint64_t>(record.index) << 32) | voltageBits,
+                   std::memory_order_relaxed);
+  m_head.store(HEAD + 1, std::memory_order_release);
+  m_pushed.fetch_add(1, std::memory_order_relaxed);
+
+  uint64_t const SIZE{HEAD + 1 - m_tail.load(std::memory_order_relaxed)};
+  if (SIZE > m_maxSize.load(std::memory_order_relaxed)) {
+    m_maxSize.store(SIZE, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+bool SampleRing::pop(SampleRecord &record) noexcept {
+  uint64_t tail{m_tail.load(std::memory_order_acquire)};
+  while (tail != m_head.load(std::memory_order_acquire)) {
+    Slot const &slot{m_slots[tail % m_capacity]};
+    uint64_t const SAMPLE_TIME{slot.sampleTime.load(std::memory_order_relaxed)};
+    uint64_t const VALUE{slot.value.load(std::memory_order_relaxed)};
+    // Fails when the producer dropped this record meanwhile; tail is then
+    // reloaded and the next one is tried.
+    if (m_tail.compare_exchange_weak(tail, tail + 1,
+                                     std::memory_order_acq_rel)) {
+      uint32_t const VOLTAGE_BITS{static_cast<uint32_t>(VALUE)};
+      record.sampleTime = static_cast<int64_t>(SAMPLE_TIME);
+      std::memcpy(&record.voltage, &VOLTAGE_BITS, sizeof(record.voltage));
+      record.index = static_cast<uint32_t>(VALUE >> 32);
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t SampleRing::capacity() const noexcept {
+  return m_capacity;
+}
+
+size_t SampleRing::size() const noexcept {
+  uint64_t const TAIL{m_tail.load(std::memory_order_relaxed)};
+  uint64_t const HEAD{m_head.load(std::memory_order_relaxed)};
+  return (HEAD > TAIL) ? static_cast<size_t>(HEAD - TAIL) : 0;
+}
+
+size_t SampleRing::maxSize() const noexcept {
+  return static_cast<size_t>(m_maxSize.load(std::memory_order_relaxed));
+}
+
+uint64_t SampleRing::pushed() const noexcept {
+  return m_pushed.load(std::memory_order_relaxed);
+}
+
+uint64_t SampleRing::dropped() const noexcept {
+  return m_dropped.load(std::memory_order_relaxed);
+}
+
+std::string SampleRing::summary() const noexcept {
+  return "ring=" + std::to_string(size()) + "/" + std::to_string(capacity()) +
+         " ring-max=" + std::to_string(maxSize()) +
+         " ring-dropped=" + std::to_string(dropped());
+}
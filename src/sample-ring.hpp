@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SAMPLE_RING_HPP
+#define SAMPLE_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * A converted and timestamped sample as handed from the sampling thread to
+ * the publisher thread.
+ */
+struct SampleRecord {
+  int64_t sampleTime{0};
+  float voltage{0.0f};
+  uint32_t index{0};
+};
+
+enum class OverflowPolicy { DropOldest, DropNewest };
+
+bool parseOverflowPolicy(std::string const &name, OverflowPolicy &policy) noexcept;
+
+/**
+ * Bounded single-producer/single-consumer ring of sample records. Pushing
+ * never blocks: on a full ring, either the new record is dropped or the
+ * oldest queued one is, by the producer advancing the read index with one
+ * compare-and-swap. The consumer claims a record with a compare-and-swap on
+ * the same index, so a record overwritten while it was being copied is
+ * never returned. Records are stored as relaxed atomic words to keep that
+ * copy free of data races. The counters may be read from any thread.
+ */
+class SampleRing {
+ private:
+  SampleRing(SampleRing const &) = delete;
+  SampleRing(SampleRing &&) = delete;
+  SampleRing &operator=(SampleRing const &) = delete;
+  SampleRing &operator=(SampleRing &&) = delete;
+
+ public:
+  // Records a ring holds at most.
+  static size_t const MAX_CAPACITY{16777216};
+
+ public:
+  SampleRing(size_t capacity, OverflowPolicy policy) noexcept;
+  ~SampleRing() = default;
+
+ public:
+  bool push(SampleRecord const &record) noexcept;
+  bool pop(SampleRecord &record) noexcept;
+  size_t capacity() const noexcept;
+  size_t size() const noexcept;
+  size_t maxSize() const noexcept;
+  uint64_t pushed() const noexcept;
+  uint64_t dropped() const noexcept;
+  std::string summary() const noexcept;
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> sampleTime{0};
+    std::atomic<uint64_t> value{0};
+  };
+
+ private:
+  size_t m_capacity;
+  OverflowPolicy m_policy;
+  std::unique_ptr<Slot[]> m_slots;
+  // Padding keeps the producer and consumer indices on separate cache lines
+  // without needing over-aligned allocation.
+  char m_padding0[64];
+  std::atomic<uint64_t> m_head;
+  char m_padding1[64];
+  std::atomic<uint64_t> m_tail;
+  char m_padding2[64];
+  std::atomic<uint64_t> m_maxSize;
+  std::atomic<uint64_t> m_pushed;
+  std::atomic<uint64_t> m_dropped;
+};
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <limits>
+
+#include "sampling-leases.hpp"
+
+bool makeSamplingLease(uint32_t holder, uint8_t channel, float frequency,
+                       float duration, float maxFrequency, int64_t now,
+                       SamplingLease &lease) noexcept {
+  bool const IS_RETURNED{!(0.0f < frequency || 0.0f > frequency)};
+  if (!std::isfinite(frequency) || frequency < 0.0f ||
+      frequency > maxFrequency) {
+    return false;
+  }
+  if (!IS_RETURNED && (!std::isfinite(duration) || !(duration > 0.0f) ||
+                       duration > MAX_LEASE_DURATION)) {
+    return false;
+  }
+  lease.holder = holder;
+  lease.channel = channel;
+  lease.frequency = frequency;
+  lease.expiresAt =
+      IS_RETURNED ? now
+                  : now + static_cast<int64_t>(static_cast<double>(duration) *
+                                               1.0e9);
+  return true;
+}
+
+SamplingLeases::SamplingLeases(size_t capacity) noexcept
+    : m_capacity{capacity},
+      m_leases{},
+      m_nextExpiry{std::numeric_limits<int64_t>::max()} {
+  m_leases.reserve(m_capacity);
+}
+
+bool SamplingLeases::grant(SamplingLease const &lease, int64_t now) noexcept {
+  bool const IS_RETURNED{!(lease.frequency > 0.0f) || lease.expiresAt <= now};
+  for (auto it = m_leases.begin(); it != m_leases.end(); it++) {
+    if (it->holder == lease.holder && it->channel == lease.channel) {
+      if (IS_RETURNED) {
+        m_leases.erase(it);
+      } else {
+        *it = lease;
+      }
+      updateNextExpiry();
+      return true;
+    }
+  }
+  if (IS_RETURNED) {
+    return true;
+  }
+  if (m_leases.size() >= m_capacity) {
+    return false;
+  }
+  m_leases.push_back(lease);
+  updateNextExpiry();
+  return true;
+}
+
+bool SamplingLeases::expire(int64_t now) noexcept {
+  if (now < m_nextExpiry) {
+    return false;
+  }
+  size_t kept{0};
+  for (size_t i{0}; i < m_leases.size(); i++) {
+    if (m_leases[i].expiresAt > now) {
+      m_leases[kept++] = m_leases[i];
+    }
+  }
+  m_leases.resize(kept);
+  updateNextExpiry();
+  return true;
+}
+
+float SamplingLeases::frequency(float idleFrequency) const noexcept {
+  float frequency{idleFrequency};
+  for (auto const &lease : m_leases) {
+    frequency = (lease.frequency > frequency) ? lease.frequency : frequency;
+  }
+  return frequency;
+}
+
+int64_t SamplingLeases::nextExpiry() const noexcept {
+  return m_nextExpiry;
+}
+
+size_t SamplingLeases::size() const noexcept {
+  return m_leases.size();
+}
+
+void SamplingLeases::updateNextExpiry() noexcept {
+  m_nextExpiry = std::numeric_limits<int64_t>::max();
+  for (auto const &lease : m_leases) {
+    m_nextExpiry = (lease.expiresAt < m_nextExpiry) ? lease.expiresAt
+                                                    : m_nextExpiry;
+  }
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SAMPLING_LEASES_HPP
+#define SAMPLING_LEASES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct SamplingLease {
+  uint32_t holder{0};
+  uint8_t channel{0};
+  float frequency{0.0f};
+  int64_t expiresAt{0};  // Nanoseconds on the monotonic clock.
+};
+
+// Longest lease granted at once; holders renew for longer.
+float const MAX_LEASE_DURATION{3600.0f};  // Seconds.
+
+/**
+ * Builds a lease from a request off the network. A rate of 0 returns the
+ * lease. Otherwise the rate must be positive and at most maxFrequency, and
+ * the duration must be positive and at most MAX_LEASE_DURATION. NaN and
+ * infinity are rejected, as they could not be converted to an expiry time.
+ */
+bool makeSamplingLease(uint32_t holder, uint8_t channel, float frequency,
+                       float duration, float maxFrequency, int64_t now,
+                       SamplingLease &lease) noexcept;
+
+/**
+ * Rates that subscribers asked for, each until its lease expires. A lease
+ * is identified by its holder and channel, so renewing it replaces it, and
+ * a lease with a rate or remaining time of 0 is returned. The table has a
+ * fixed capacity; checking for expiry is a single comparison.
+ */
+class SamplingLeases {
+ private:
+  SamplingLeases(SamplingLeases const &) = delete;
+  SamplingLeases(SamplingLeases &&) = delete;
+  SamplingLeases &operator=(SamplingLeases const &) = delete;
+  SamplingLeases &operator=(SamplingLeases &&) = delete;
+
+ public:
+  explicit SamplingLeases(size_t capacity) noexcept;
+  ~SamplingLeases() = default;
+
+ public:
+  bool grant(SamplingLease const &lease, int64_t now) noexcept;
+  bool expire(int64_t now) noexcept;
+  float frequency(float idleFrequency) const noexcept;
+  int64_t nextExpiry() const noexcept;
+  size_t size() const noexcept;
+
+ private:
+  void updateNextExpiry() noexcept;
+
+ private:
+  size_t m_capacity;
+  std::vector<SamplingLease> m_leases;
+  int64_t m_nextExpiry;
+};
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHARED_VOLTAGE_READER_HPP
+#define SHARED_VOLTAGE_READER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Layout of the shared-memory voltage area and a reader for it. This header
+ * has no dependencies, so that co-located processes can include it as is;
+ * the area is mapped by attaching a cluon::SharedMemory of the same name
+ * with size 0, and passing its data() and size() to a Reader.
+ *
+ * The area starts, 64-byte aligned, with a SharedVoltageHeader followed by
+ * one SharedVoltageChannel per channel, each followed by its ring of
+ * SharedVoltageSlots. Sample n of a channel lives in slot n % capacity, whose
+ * sequence is 2n + 1 while it is written and 2n + 2 once complete. A reader
+ * therefore needs no lock and no syscall: it checks the sequence before and
+ * after copying a slot and retries or gives up when it changed. Any number of
+ * readers can attach since they never write to the area.
+ */
+namespace shared_voltage {
+
+uint32_t const MAGIC{0x56434441};  // "ADCV"
+uint32_t const VERSION{1};
+size_t const ALIGNMENT{64};
+
+struct Header {
+  std::atomic<uint32_t> magic;
+  uint32_t version;
+  uint32_t channelCount;
+  uint32_t capacity;
+};
+
+struct Channel {
+  std::atomic<uint64_t> head;  // Number of samples written.
+  uint32_t channel;
+  uint32_t senderStamp;
+};
+
+struct Slot {
+  std::atomic<uint64_t> sequence;
+  std::atomic<int64_t> sampleTime;  // Microseconds since the epoch.
+  std::atomic<uint32_t> voltage;    // IEEE 754 bits of the voltage.
+};
+
+struct Sample {
+  uint64_t number{0};
+  int64_t sampleTime{0};
+  float voltage{0.0f};
+};
+
+inline char *align(char *data) noexcept {
+  uintptr_t const ADDRESS{reinterpret_cast<uintptr_t>(data)};
+  return data + ((ALIGNMENT - ADDRESS % ALIGNMENT) % ALIGNMENT);
+}
+
+inline size_t channelSize(uint32_t capacity) noexcept {
+  size_t const SIZE{sizeof(Channel) + capacity * sizeof(Slot)};
+  return (SIZE + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+inline size_t areaSize(uint32_t channelCount, uint32_t capacity) noexcept {
+  return ALIGNMENT + ALIGNMENT + channelCount * channelSize(capacity);
+}
+
+/**
+ * Reads samples from a mapped area; data and size are those of the mapping.
+ */
+class Reader {
+ public:
+  Reader(char *data, size_t size) noexcept
+      : m_header{nullptr}, m_base{nullptr} {
+    if (nullptr == data || size < areaSize(0, 0)) {
+      return;
+    }
+    char *base{align(data)};
+    Header *header{reinterpret_cast<Header *>(base)};
+    if (MAGIC != header->magic.load(std::memory_order_acquire) ||
+        VERSION != header->version ||
+        static_cast<size_t>(base - data) +
+                areaSize(header->channelCount, header->capacity) - ALIGNMENT >
+            size) {
+      return;
+    }
+    m_header = header;
+    m_base = base;
+  }
+
+  bool isValid() const noexcept {
+    return nullptr != m_header;
+  }
+
+  uint32_t channelCount() const noexcept {
+    return isValid() ? m_header->channelCount : 0;
+  }
+
+  uint32_t capacity() const noexcept {
+    return isValid() ? m_header->capacity : 0;
+  }
+
+  uint32_t channel(uint32_t index) const noexcept {
+    return channelAt(index).channel;
+  }
+
+  uint32_t senderStamp(uint32_t index) const noexcept {
+    return channelAt(index).senderStamp;
+  }
+
+  // The number of samples written so far; the newest is head - 1.
+  uint64_t head(uint32_t index) const noexcept {
+    return channelAt(index).head.load(std::memory_order_acquire);
+  }
+
+  // False if sample number is not written yet or was already overwritten.
+  bool read(uint32_t index, uint64_t number, Sample &sample) const noexcept {
+    Slot const *slots{reinterpret_cast<Slot const *>(&channelAt(index) + 1)};
+    Slot const &slot{slots[number % m_header->capacity]};
+    uint64_t const EXPECTED{2 * number + 2};
+    if (EXPECTED != slot.sequence.load(std::memory_order_acquire)) {
+      return false;
+    }
+    int64_t const SAMPLE_TIME{slot.sampleTime.load(std::memory_order_relaxed)};
+    uint32_t const VOLTAGE{slot.voltage.load(std::memory_order_relaxed)};
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (EXPECTED != slot.sequence.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    sample.number = number;
+    sample.sampleTime = SAMPLE_TIME;
+    std::memcpy(&sample.voltage, &VOLTAGE, sizeof(sample.voltage));
+    return true;
+  }
+
+  // Reads the newest sample, retrying while the writer overtakes the reader.
+  bool latest(uint32_t index, Sample &sample) const noexcept {
+    for (uint32_t attempt{0}; attempt < 16; attempt++) {
+      uint64_t const HEAD{head(index)};
+      if (0 == HEAD) {
+        return false;
+      }
+      if (read(index, HEAD - 1, sample)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  Channel &channelAt(uint32_t index) const noexcept {
+    return *reinterpret_cast<Channel *>(m_base + ALIGNMENT +
+                                        index * channelSize(m_header->capacity));
+  }
+
+ private:
+  Header *m_header;
+  char *m_base;
+};
+
+}  // namespace shared_voltage
+
+#endif
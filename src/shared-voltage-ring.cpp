@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <new>
+
+#include "cluon-complete.hpp"
+#include "shared-voltage-ring.hpp"
+
+uint32_t const SharedVoltageRing::MAX_CAPACITY;
+
+SharedVoltageRing::SharedVoltageRing(
+    std::string const &name, std::vector<AdcChannelConfig> const &configs,
+    uint32_t capacity) noexcept
+    : m_sharedMemory{},
+      m_capacity{(capacity > 0) ? capacity : 1},
+      m_channels{} {
+  uint32_t const CHANNEL_COUNT{static_cast<uint32_t>(configs.size())};
+  size_t const SIZE{shared_voltage::areaSize(CHANNEL_COUNT, m_capacity)};
+  m_sharedMemory.reset(
+      new cluon::SharedMemory(name, static_cast<uint32_t>(SIZE)));
+  if (!m_sharedMemory->valid()) {
+    return;
+  }
+  std::memset(m_sharedMemory->data(), 0, SIZE);
+  char *base{shared_voltage::align(m_sharedMemory->data())};
+  shared_voltage::Header *header{new (base) shared_voltage::Header};
+  header->version = shared_voltage::VERSION;
+  header->channelCount = CHANNEL_COUNT;
+  header->capacity = m_capacity;
+  for (uint32_t i{0}; i < CHANNEL_COUNT; i++) {
+    char *channelBase{base + shared_voltage::ALIGNMENT +
+                      i * shared_voltage::channelSize(m_capacity)};
+    shared_voltage::Channel *channel{new (channelBase)
+                                         shared_voltage::Channel};
+    channel->head.store(0, std::memory_order_relaxed);
+    channel->channel = configs[i].channel;
+    channel->senderStamp = configs[i].senderStamp;
+    shared_voltage::Slot *slots{
+        reinterpret_cast<shared_voltage::Slot *>(channel + 1)};
+    for (uint32_t j{0}; j < m_capacity; j++) {
+      new (&slots[j]) shared_voltage::Slot;
+      slots[j].sequence.store(0, std::memory_order_relaxed);
+    }
+    m_channels.push_back(channel);
+  }
+  // Published last, so that readers never see a partial layout.
+  header->magic.store(shared_voltage::MAGIC, std::memory_order_release);
+}
+
+SharedVoltageRing::~SharedVoltageRing() noexcept {
+  if (isValid()) {
+    shared_voltage::Header *header{reinterpret_cast<shared_voltage::Header *>(
+        shared_voltage::align(m_sharedMemory->data()))};
+    header->magic.store(0, std::memory_order_release);
+  }
+}
+
+bool SharedVoltageRing::isValid() const noexcept {
+  return m_sharedMemory && !m_channels.empty();
+}
+
+void SharedVoltageRing::write(size_t index, float voltage,
+                              int64_t sampleTimeInMicroseconds) noexcept {
+  shared_voltage::Channel &channel{*m_channels[index]};
+  uint64_t const NUMBER{channel.head.load(std::memory_order_relaxed)};
+  shared_voltage::Slot &slot{reinterpret_cast<shared_voltage::Slot *>(
+      &channel + 1)[NUMBER % m_capacity]};
+  uint32_t voltageBits{0};
+  std::memcpy(&voltageBits, &voltage, sizeof(voltageBits));
+
+  slot.sequence.store(2 * NUMBER + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.sampleTime.store(sampleTimeInMicroseconds, std::memory_order_relaxed);
+  slot.voltage.store(voltageBits, std::memory_order_relaxed);
+  slot.sequence.store(2 * NUMBER + 2, std::memory_order_release);
+  channel.head.store(NUMBER + 1, std::memory_order_release);
+}
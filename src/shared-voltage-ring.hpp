@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHARED_VOLTAGE_RING_HPP
+#define SHARED_VOLTAGE_RING_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "adc-sampler.hpp"
+#include "shared-voltage-reader.hpp"
+
+namespace cluon {
+class SharedMemory;
+}
+
+/**
+ * Writer side of the shared-memory voltage area described in
+ * shared-voltage-reader.hpp, with one ring of the given capacity per
+ * configured channel. There must be a single writer per area.
+ */
+class SharedVoltageRing {
+ private:
+  SharedVoltageRing(SharedVoltageRing const &) = delete;
+  SharedVoltageRing(SharedVoltageRing &&) = delete;
+  SharedVoltageRing &operator=(SharedVoltageRing const &) = delete;
+  SharedVoltageRing &operator=(SharedVoltageRing &&) = delete;
+
+ public:
+  // Samples a ring of one channel holds at most.
+  static uint32_t const MAX_CAPACITY{1048576};
+
+ public:
+  SharedVoltageRing(std::string const &name,
+                    std::vector<AdcChannelConfig> const &configs,
+                    uint32_t capacity) noexcept;
+  ~SharedVoltageRing() noexcept;
+
+ public:
+  bool isValid() const noexcept;
+  void write(size_t index, float voltage,
+             int64_t sampleTimeInMicroseconds) noexcept;
+
+ private:
+  std::unique_ptr<cluon::SharedMemory> m_sharedMemory;
+  uint32_t m_capacity;
+  std::vector<shared_voltage::Channel *> m_channels;
+};
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "udp-batch-sender.hpp"
+
+size_t const UdpBatchSender::SLOT_SIZE;
+size_t const UdpBatchSender::MAX_QUEUE;
+int64_t const UdpBatchSender::MAX_DELAY;
+
+UdpBatchSender::UdpBatchSender(std::string const &address, uint16_t port,
+                               size_t queueLength,
+                               int64_t maxDelayInNanoseconds) noexcept
+    : m_socket{::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_UDP)},
+      m_address{},
+      m_queueLength{(queueLength > 0 && queueLength <= MAX_QUEUE) ? queueLength
+                                                                  : MAX_QUEUE},
+      m_maxDelay{maxDelayInNanoseconds},
+      m_oldest{0},
+      m_queued{0},
+      m_slots(m_queueLength * SLOT_SIZE),
+      m_iovecs(m_queueLength),
+      m_messages(m_queueLength),
+      m_datagrams{0},
+      m_bytes{0},
+      m_syscalls{0},
+      m_errors{0} {
+  m_address.sin_family = AF_INET;
+  m_address.sin_port = htons(port);
+  m_address.sin_addr.s_addr = ::inet_addr(address.c_str());
+  for (size_t i{0}; i < m_queueLength; i++) {
+    m_iovecs[i].iov_base = m_slots.data() + i * SLOT_SIZE;
+    std::memset(&m_messages[i], 0, sizeof(m_messages[i]));
+    m_messages[i].msg_hdr.msg_name = &m_address;
+    m_messages[i].msg_hdr.msg_namelen = sizeof(m_address);
+    m_messages[i].msg_hdr.msg_iov = &m_iovecs[i];
+    m_messages[i].msg_hdr.msg_iovlen = 1;
+  }
+}
+
+UdpBatchSender::~UdpBatchSender() noexcept {
+  if (m_socket >= 0) {
+    flush();
+    ::close(m_socket);
+  }
+}
+
+bool UdpBatchSender::isOpen() const noexcept {
+  return m_socket >= 0;
+}
+
+void UdpBatchSender::send(char const *data, size_t size, int64_t now) noexcept {
+  if (size > SLOT_SIZE) {
+    flush();
+    ssize_t const SENT{::sendto(
+        m_socket, data, size, 0,
+        reinterpret_cast<struct sockaddr const *>(&m_address),
+        sizeof(m_address))};
+    m_syscalls.fetch_add(1, std::memory_order_relaxed);
+    if (SENT < 0) {
+      m_errors.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      m_datagrams.fetch_add(1, std::memory_order_relaxed);
+      m_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    return;
+  }
+  if (0 == m_queued) {
+    m_oldest = now;
+  }
+  std::memcpy(m_slots.data() + m_queued * SLOT_SIZE, data, size);
+  m_iovecs[m_queued].iov_len = size;
+  m_queued++;
+  if (m_queued >= m_queueLength) {
+    flush();
+  }
+}
+
+void UdpBatchSender::onTickEnd(int64_t now) noexcept {
+  if (m_queued > 0 && now - m_oldest >= m_maxDelay) {
+    flush();
+  }
+}
+
+void UdpBatchSender::flush() noexcept {
+  size_t sent{0};
+  while (sent < m_queued) {
+    int32_t const N{::sendmmsg(m_socket, &m_messages[sent],
+                               static_cast<uint32_t>(m_queued - sent), 0)};
+    m_syscalls.fetch_add(1, std::memory_order_relaxed);
+    if (N < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      // The remaining datagrams are dropped rather than retried.
+      m_errors.fetch_add(m_queued - sent, std::memory_order_relaxed);
+      break;
+    }
+    for (size_t i{sent}; i < sent + static_cast<size_t>(N); i++) {
+      m_bytes.fetch_add(m_iovecs[i].iov_len, std::memory_order_relaxed);
+    }
+    m_datagrams.fetch_add(static_cast<uint64_t>(N), std::memory_order_relaxed);
+    sent += static_cast<size_t>(N);
+  }
+  m_queued = 0;
+}
+
+size_t UdpBatchSender::queued() const noexcept {
+  return m_queued;
+}
+
+uint64_t UdpBatchSender::datagrams() const noexcept {
+  return m_datagrams.load(std::memory_order_relaxed);
+}
+
+uint64_t UdpBatchSender::bytes() const noexcept {
+  return m_bytes.load(std::memory_order_relaxed);
+}
+
+uint64_t UdpBatchSender::syscalls() const noexcept {
+  return m_syscalls.load(std::memory_order_relaxed);
+}
+
+uint64_t UdpBatchSender::errors() const noexcept {
+  return m_errors.load(std::memory_order_relaxed);
+}
+
+std::string UdpBatchSender::summary() const noexcept {
+  return "datagrams=" + std::to_string(datagrams()) +
+         " syscalls=" + std::to_string(syscalls()) +
+         " errors=" + std::to_string(errors());
+}
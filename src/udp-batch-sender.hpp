@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UDP_BATCH_SENDER_HPP
+#define UDP_BATCH_SENDER_HPP
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * UDP sender that queues small serialized envelopes and sends them with one
+ * sendmmsg() call. The queue is flushed when it holds the configured number
+ * of datagrams, 1 to MAX_QUEUE, and by the owner at the end of a tick once
+ * the oldest queued datagram is at least maxDelay old, 0 to MAX_DELAY
+ * nanoseconds (0 flushes at every tick); the owner validates both. Datagrams
+ * larger than a slot are sent right away, after flushing the queue to keep
+ * the order.
+ */
+class UdpBatchSender {
+ private:
+  UdpBatchSender(UdpBatchSender const &) = delete;
+  UdpBatchSender(UdpBatchSender &&) = delete;
+  UdpBatchSender &operator=(UdpBatchSender const &) = delete;
+  UdpBatchSender &operator=(UdpBatchSender &&) = delete;
+
+ public:
+  static size_t const SLOT_SIZE{64};
+  static size_t const MAX_QUEUE{64};
+  static int64_t const MAX_DELAY{1000000000};
+
+ public:
+  UdpBatchSender(std::string const &address, uint16_t port,
+                 size_t queueLength, int64_t maxDelayInNanoseconds) noexcept;
+  ~UdpBatchSender() noexcept;
+
+ public:
+  bool isOpen() const noexcept;
+  void send(char const *data, size_t size, int64_t now) noexcept;
+  void onTickEnd(int64_t now) noexcept;
+  void flush() noexcept;
+  size_t queued() const noexcept;
+  uint64_t datagrams() const noexcept;
+  uint64_t bytes() const noexcept;
+  uint64_t syscalls() const noexcept;
+  uint64_t errors() const noexcept;
+  std::string summary() const noexcept;
+
+ private:
+  int32_t m_socket;
+  struct sockaddr_in m_address;
+  size_t m_queueLength;
+  int64_t m_maxDelay;
+  int64_t m_oldest;
+  size_t m_queued;
+  std::vector<char> m_slots;
+  std::vector<struct iovec> m_iovecs;
+  std::vector<struct mmsghdr> m_messages;
+  std::atomic<uint64_t> m_datagrams;
+  std::atomic<uint64_t> m_bytes;
+  std::atomic<uint64_t> m_syscalls;
+  std::atomic<uint64_t> m_errors;
+};
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <stdexcept>
+
+#include "voltage-alarm.hpp"
+
+std::vector<AlarmRule> parseAlarmRules(std::string const &rules) {
+  std::vector<AlarmRule> alarmRules;
+  std::stringstream sstr(rules);
+  std::string token;
+  while (std::getline(sstr, token, ',')) {
+    if (token.empty()) {
+      continue;
+    }
+    std::vector<std::string> fields;
+    std::stringstream fieldStream(token);
+    std::string field;
+    while (std::getline(fieldStream, field, ':')) {
+      fields.push_back(field);
+    }
+    if (fields.size() < 2 || fields.size() > 4) {
+      throw std::invalid_argument(
+          "Alarm rule '" + token +
+          "' is not <channel>:<threshold>[:<release>[:<duration ms>]].");
+    }
+    AlarmRule rule;
+    int32_t const CHANNEL{std::stoi(fields[0])};
+    if (CHANNEL < 0 || CHANNEL > 6) {
+      throw std::invalid_argument(
+          "Not supported alarm channel, must be between 0 and 6.");
+    }
+    rule.channel = static_cast<uint8_t>(CHANNEL);
+    rule.threshold = std::stof(fields[1]);
+    rule.release = (fields.size() > 2) ? std::stof(fields[2]) : rule.threshold;
+    rule.minDuration = (fields.size() > 3)
+                           ? static_cast<int64_t>(std::stof(fields[3]) * 1000.0f)
+                           : 0;
+    if (rule.release < rule.threshold || rule.minDuration < 0) {
+      throw std::invalid_argument(
+          "Alarm rule '" + token +
+          "' needs a release voltage not below its threshold and a "
+          "non-negative duration.");
+    }
+    alarmRules.push_back(rule);
+  }
+  return alarmRules;
+}
+
+VoltageAlarm::VoltageAlarm(AlarmRule const &rule) noexcept
+    : m_rule(rule), m_isBelow{false}, m_isActive{false}, m_since{0} {}
+
+VoltageAlarm::Transition VoltageAlarm::update(
+    float voltage, int64_t sampleTimeInMicroseconds) noexcept {
+  if (voltage < m_rule.threshold) {
+    if (!m_isBelow) {
+      m_isBelow = true;
+      m_since = sampleTimeInMicroseconds;
+    }
+    if (!m_isActive &&
+        sampleTimeInMicroseconds - m_since >= m_rule.minDuration) {
+      m_isActive = true;
+      return RAISED;
+    }
+  } else {
+    m_isBelow = false;
+    if (m_isActive && voltage > m_rule.release) {
+      m_isActive = false;
+      return CLEARED;
+    }
+  }
+  return NONE;
+}
+
+AlarmRule const &VoltageAlarm::rule() const noexcept {
+  return m_rule;
+}
+
+bool VoltageAlarm::isActive() const noexcept {
+  return m_isActive;
+}
+
+int64_t VoltageAlarm::since() const noexcept {
+  return m_since;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VOLTAGE_ALARM_HPP
+#define VOLTAGE_ALARM_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Undervoltage rule for one channel: the alarm is raised once the voltage
+ * stayed below threshold for at least the minimum duration, and cleared as
+ * soon as it rises above the release voltage, which is at least the
+ * threshold so that noise around the threshold cannot toggle it.
+ */
+struct AlarmRule {
+  uint8_t channel{0};
+  float threshold{0.0f};
+  float release{0.0f};
+  int64_t minDuration{0};  // Microseconds.
+};
+
+/**
+ * Parses comma-separated <channel>:<threshold V>[:<release V>[:<minimum
+ * duration ms>]] rules; the release defaults to the threshold and the
+ * duration to 0. Throws std::invalid_argument on malformed input.
+ */
+std::vector<AlarmRule> parseAlarmRules(std::string const &rules);
+
+/**
+ * State of one rule, updated with every sample of its channel.
+ */
+class VoltageAlarm {
+ private:
+  VoltageAlarm(VoltageAlarm const &) = delete;
+  VoltageAlarm &operator=(VoltageAlarm const &) = delete;
+  VoltageAlarm &operator=(VoltageAlarm &&) = delete;
+
+ public:
+  enum Transition { NONE, RAISED, CLEARED };
+
+ public:
+  explicit VoltageAlarm(AlarmRule const &rule) noexcept;
+  VoltageAlarm(VoltageAlarm &&) = default;
+  ~VoltageAlarm() = default;
+
+ public:
+  Transition update(float voltage, int64_t sampleTimeInMicroseconds) noexcept;
+  AlarmRule const &rule() const noexcept;
+  bool isActive() const noexcept;
+  int64_t since() const noexcept;
+
+ private:
+  AlarmRule m_rule;
+  bool m_isBelow;
+  bool m_isActive;
+  int64_t m_since;
+};
+
+#endif
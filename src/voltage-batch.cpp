@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <endian.h>
+
+#include <cstring>
+
+#include "voltage-batch.hpp"
+
+uint32_t const VoltageBatch::MAX_SAMPLES;
+int64_t const VoltageBatch::MAX_AGE;
+
+namespace {
+uint32_t clampSamples(uint32_t maxSamples) noexcept {
+  return (maxSamples > 0 && maxSamples < VoltageBatch::MAX_SAMPLES)
+             ? maxSamples
+             : VoltageBatch::MAX_SAMPLES;
+}
+}  // namespace
+
+VoltageBatch::VoltageBatch(uint32_t maxSamples, int64_t maxAgeInMicroseconds,
+                           int64_t periodInNanoseconds) noexcept
+    : m_maxSamples{clampSamples(maxSamples)},
+      m_maxAge{maxAgeInMicroseconds},
+      m_period{periodInNanoseconds},
+      m_baseTimeStamp{0},
+      m_size{0},
+      m_sequenceNumber{0},
+      m_samples{} {
+  m_samples.reserve(m_maxSamples * sizeof(float));
+}
+
+bool VoltageBatch::fits(int64_t sampleTimeInMicroseconds) const noexcept {
+  if (0 == m_size) {
+    return true;
+  }
+  int64_t const EXPECTED{m_baseTimeStamp + m_size * m_period / 1000};
+  int64_t const DEVIATION{sampleTimeInMicroseconds - EXPECTED};
+  int64_t const TOLERANCE{m_period / 2000};
+  return DEVIATION <= TOLERANCE && DEVIATION >= -TOLERANCE;
+}
+
+void VoltageBatch::add(float voltage, int64_t sampleTimeInMicroseconds) noexcept {
+  if (0 == m_size) {
+    m_baseTimeStamp = sampleTimeInMicroseconds;
+  }
+  uint32_t bits;
+  std::memcpy(&bits, &voltage, sizeof(bits));
+  bits = htole32(bits);
+  m_samples.append(reinterpret_cast<char const *>(&bits), sizeof(bits));
+  m_size++;
+}
+
+bool VoltageBatch::isFull(int64_t nowInMicroseconds) const noexcept {
+  return m_size >= m_maxSamples ||
+         (m_size > 0 && m_maxAge > 0 &&
+          nowInMicroseconds - m_baseTimeStamp >= m_maxAge);
+}
+
+bool VoltageBatch::isEmpty() const noexcept {
+  return 0 == m_size;
+}
+
+uint32_t VoltageBatch::size() const noexcept {
+  return m_size;
+}
+
+int64_t VoltageBatch::baseTimeStamp() const noexcept {
+  return m_baseTimeStamp;
+}
+
+int64_t VoltageBatch::period() const noexcept {
+  return m_period;
+}
+
+std::string const &VoltageBatch::samples() const noexcept {
+  return m_samples;
+}
+
+uint32_t VoltageBatch::clear() noexcept {
+  m_samples.clear();
+  m_size = 0;
+  return m_sequenceNumber++;
+}
+
+void VoltageBatch::reconfigure(uint32_t maxSamples,
+                               int64_t maxAgeInMicroseconds,
+                               int64_t periodInNanoseconds) noexcept {
+  m_maxSamples = clampSamples(maxSamples);
+  m_maxAge = maxAgeInMicroseconds;
+  m_period = periodInNanoseconds;
+  m_samples.clear();
+  m_size = 0;
+  m_samples.reserve(m_maxSamples * sizeof(float));
+}
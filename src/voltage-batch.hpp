@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VOLTAGE_BATCH_HPP
+#define VOLTAGE_BATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Accumulates evenly spaced voltage samples of one channel as packed
+ * little-endian floats, as carried by opendlv.device.adc.VoltageReadingBatch.
+ * A sample that does not fall on the expected time of the next slot (for
+ * example after missed deadlines) cannot extend the batch; the caller is
+ * then expected to flush first, as before reconfigure(), which keeps the
+ * sequence numbers going.
+ */
+class VoltageBatch {
+ private:
+  VoltageBatch(VoltageBatch const &) = delete;
+  VoltageBatch &operator=(VoltageBatch const &) = delete;
+  VoltageBatch &operator=(VoltageBatch &&) = delete;
+
+ public:
+  static uint32_t const MAX_SAMPLES{4096};
+  // Microseconds; a minute.
+  static int64_t const MAX_AGE{60000000};
+
+ public:
+  VoltageBatch(uint32_t maxSamples, int64_t maxAgeInMicroseconds,
+               int64_t periodInNanoseconds) noexcept;
+  VoltageBatch(VoltageBatch &&) = default;
+  ~VoltageBatch() = default;
+
+ public:
+  bool fits(int64_t sampleTimeInMicroseconds) const noexcept;
+  void add(float voltage, int64_t sampleTimeInMicroseconds) noexcept;
+  bool isFull(int64_t nowInMicroseconds) const noexcept;
+  bool isEmpty() const noexcept;
+  uint32_t size() const noexcept;
+  int64_t baseTimeStamp() const noexcept;
+  int64_t period() const noexcept;
+  std::string const &samples() const noexcept;
+  uint32_t clear() noexcept;
+  void reconfigure(uint32_t maxSamples, int64_t maxAgeInMicroseconds,
+                   int64_t periodInNanoseconds) noexcept;
+
+ private:
+  uint32_t m_maxSamples;
+  int64_t m_maxAge;
+  int64_t m_period;
+  int64_t m_baseTimeStamp;
+  uint32_t m_size;
+  uint32_t m_sequenceNumber;
+  std::string m_samples;
+};
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "voltage-envelope-encoder.hpp"
+
+size_t const VoltageEnvelopeEncoder::MAX_SIZE;
+
+// Proto keys as written by cluon::ToProtoVisitor: (field << 3) | wire type.
+static uint8_t const KEY_VARINT_1{0x08};
+static uint8_t const KEY_BYTES_2{0x12};
+static uint8_t const KEY_BYTES_3{0x1A};
+static uint8_t const KEY_BYTES_4{0x22};
+static uint8_t const KEY_BYTES_5{0x2A};
+static uint8_t const KEY_VARINT_6{0x30};
+static uint8_t const KEY_FLOAT_1{0x0D};
+static uint8_t const KEY_VARINT_2{0x10};
+
+static size_t putVarInt(uint8_t *out, uint64_t v) noexcept {
+  size_t size{0};
+  while (0x7f < v) {
+    out[size++] = static_cast<uint8_t>((v & 0x7f) | 0x80);
+    v >>= 7;
+  }
+  out[size++] = static_cast<uint8_t>(v);
+  return size;
+}
+
+static uint32_t toZigZag32(int32_t v) noexcept {
+  return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+// A cluon.data.TimeStamp nested as length-delimited field.
+static size_t putTimeStamp(uint8_t *out, uint8_t key, int32_t seconds,
+                           int32_t microseconds) noexcept {
+  uint8_t nested[12];
+  size_t length{0};
+  nested[length++] = KEY_VARINT_1;
+  length += putVarInt(nested + length, toZigZag32(seconds));
+  nested[length++] = KEY_VARINT_2;
+  length += putVarInt(nested + length, toZigZag32(microseconds));
+  out[0] = key;
+  out[1] = static_cast<uint8_t>(length);
+  std::memcpy(out + 2, nested, length);
+  return 2 + length;
+}
+
+VoltageEnvelopeEncoder::VoltageEnvelopeEncoder(int32_t dataType) noexcept
+    : m_prefix{},
+      m_prefixSize{0} {
+  // dataType, then serializedData holding a single float field.
+  m_prefix[m_prefixSize++] = KEY_VARINT_1;
+  m_prefixSize += putVarInt(m_prefix + m_prefixSize, toZigZag32(dataType));
+  m_prefix[m_prefixSize++] = KEY_BYTES_2;
+  m_prefix[m_prefixSize++] = 1 + sizeof(float);
+  m_prefix[m_prefixSize++] = KEY_FLOAT_1;
+}
+
+size_t VoltageEnvelopeEncoder::encode(char *buffer, float value,
+                                      int32_t sentSeconds,
+                                      int32_t sentMicroseconds,
+                                      int32_t sampleSeconds,
+                                      int32_t sampleMicroseconds,
+                                      uint32_t senderStamp) const noexcept {
+  constexpr size_t OD4_HEADER_SIZE{5};
+  uint8_t *out{reinterpret_cast<uint8_t *>(buffer)};
+  size_t size{OD4_HEADER_SIZE};
+
+  std::memcpy(out + size, m_prefix, m_prefixSize);
+  size += m_prefixSize;
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  for (size_t i{0}; i < sizeof(bits); i++) {
+    out[size++] = static_cast<uint8_t>(bits >> (8 * i));
+  }
+
+  size += putTimeStamp(out + size, KEY_BYTES_3, sentSeconds, sentMicroseconds);
+  size += putTimeStamp(out + size, KEY_BYTES_4, 0, 0);
+  // Like OD4Session::send, an unset sample time stamp defaults to sent.
+  bool const IS_UNSET{0 == sampleSeconds + sampleMicroseconds};
+  size += putTimeStamp(out + size, KEY_BYTES_5,
+                       IS_UNSET ? sentSeconds : sampleSeconds,
+                       IS_UNSET ? sentMicroseconds : sampleMicroseconds);
+  out[size++] = KEY_VARINT_6;
+  size += putVarInt(out + size, senderStamp);
+
+  // OD4 header: 0x0D 0xA4, then the envelope length as 24 bit little endian.
+  size_t const LENGTH{size - OD4_HEADER_SIZE};
+  out[0] = 0x0D;
+  out[1] = 0xA4;
+  out[2] = static_cast<uint8_t>(LENGTH);
+  out[3] = static_cast<uint8_t>(LENGTH >> 8);
+  out[4] = static_cast<uint8_t>(LENGTH >> 16);
+  return size;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VOLTAGE_ENVELOPE_ENCODER_HPP
+#define VOLTAGE_ENVELOPE_ENCODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Allocation-free encoder for an OD4 datagram carrying a message with a
+ * single float field, such as opendlv.proxy.VoltageReading. The output is
+ * byte-identical to cluon::serializeEnvelope() of the envelope built by
+ * cluon::OD4Session::send(): the constant parts (data type, payload key and
+ * length, the empty received time stamp) are prepared once, and only the
+ * value, the time stamps and the senderStamp are written per sample.
+ */
+class VoltageEnvelopeEncoder {
+ private:
+  VoltageEnvelopeEncoder(VoltageEnvelopeEncoder const &) = delete;
+  VoltageEnvelopeEncoder(VoltageEnvelopeEncoder &&) = delete;
+  VoltageEnvelopeEncoder &operator=(VoltageEnvelopeEncoder const &) = delete;
+  VoltageEnvelopeEncoder &operator=(VoltageEnvelopeEncoder &&) = delete;
+
+ public:
+  static size_t const MAX_SIZE{64};
+
+ public:
+  VoltageEnvelopeEncoder(int32_t dataType) noexcept;
+  ~VoltageEnvelopeEncoder() = default;
+
+ public:
+  size_t encode(char *buffer, float value, int32_t sentSeconds,
+                int32_t sentMicroseconds, int32_t sampleSeconds,
+                int32_t sampleMicroseconds, uint32_t senderStamp) const
+      noexcept;
+
+ private:
+  uint8_t m_prefix[16];
+  size_t m_prefixSize;
+};
+
+#endif
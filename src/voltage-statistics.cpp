@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "voltage-statistics.hpp"
+
+int64_t const VoltageStatistics::MAX_WINDOW;
+
+VoltageStatistics::VoltageStatistics(int64_t windowInMicroseconds) noexcept
+    : m_window{(windowInMicroseconds <= 0)
+                   ? 1
+                   : ((windowInMicroseconds < MAX_WINDOW) ? windowInMicroseconds
+                                                          : MAX_WINDOW)},
+      m_windowStart{0},
+      m_count{0},
+      m_minimum{0.0f},
+      m_maximum{0.0f},
+      m_mean{0.0},
+      m_m2{0.0} {}
+
+bool VoltageStatistics::isInWindow(
+    int64_t sampleTimeInMicroseconds) const noexcept {
+  return 0 == m_count || (sampleTimeInMicroseconds >= m_windowStart &&
+                          sampleTimeInMicroseconds < m_windowStart + m_window);
+}
+
+void VoltageStatistics::add(float voltage,
+                            int64_t sampleTimeInMicroseconds) noexcept {
+  if (0 == m_count) {
+    int64_t const REMAINDER{sampleTimeInMicroseconds % m_window};
+    m_windowStart = sampleTimeInMicroseconds - REMAINDER -
+                    ((REMAINDER < 0) ? m_window : 0);
+    m_minimum = voltage;
+    m_maximum = voltage;
+  }
+  m_minimum = (voltage < m_minimum) ? voltage : m_minimum;
+  m_maximum = (voltage > m_maximum) ? voltage : m_maximum;
+  m_count++;
+  double const VOLTAGE{static_cast<double>(voltage)};
+  double const DELTA{VOLTAGE - m_mean};
+  m_mean += DELTA / m_count;
+  m_m2 += DELTA * (VOLTAGE - m_mean);
+}
+
+void VoltageStatistics::clear() noexcept {
+  m_count = 0;
+  m_mean = 0.0;
+  m_m2 = 0.0;
+}
+
+int64_t VoltageStatistics::windowStart() const noexcept {
+  return m_windowStart;
+}
+
+int64_t VoltageStatistics::window() const noexcept {
+  return m_window;
+}
+
+uint32_t VoltageStatistics::count() const noexcept {
+  return m_count;
+}
+
+float VoltageStatistics::minimum() const noexcept {
+  return m_minimum;
+}
+
+float VoltageStatistics::maximum() const noexcept {
+  return m_maximum;
+}
+
+float VoltageStatistics::mean() const noexcept {
+  return static_cast<float>(m_mean);
+}
+
+float VoltageStatistics::variance() const noexcept {
+  return (m_count > 1) ? static_cast<float>(m_m2 / (m_count - 1)) : 0.0f;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VOLTAGE_STATISTICS_HPP
+#define VOLTAGE_STATISTICS_HPP
+
+#include <cstdint>
+
+/**
+ * Streaming statistics of one channel over tumbling time windows aligned to
+ * multiples of the window length. Each sample costs O(1): minimum and
+ * maximum are tracked directly, mean and variance with Welford's method,
+ * which stays accurate for long windows of nearly equal values. Windows are
+ * at most MAX_WINDOW long, so that the count of a window sampled at the
+ * highest rate does not wrap.
+ */
+class VoltageStatistics {
+ private:
+  VoltageStatistics(VoltageStatistics const &) = delete;
+  VoltageStatistics &operator=(VoltageStatistics const &) = delete;
+  VoltageStatistics &operator=(VoltageStatistics &&) = delete;
+
+ public:
+  static int64_t const MAX_WINDOW{3600000000};
+
+ public:
+  explicit VoltageStatistics(int64_t windowInMicroseconds) noexcept;
+  VoltageStatistics(VoltageStatistics &&) = default;
+  ~VoltageStatistics() = default;
+
+ public:
+  bool isInWindow(int64_t sampleTimeInMicroseconds) const noexcept;
+  void add(float voltage, int64_t sampleTimeInMicroseconds) noexcept;
+  void clear() noexcept;
+  int64_t windowStart() const noexcept;
+  int64_t window() const noexcept;
+  uint32_t count() const noexcept;
+  float minimum() const noexcept;
+  float maximum() const noexcept;
+  float mean() const noexcept;
+  float variance() const noexcept;
+
+ private:
+  int64_t m_window;
+  int64_t m_windowStart;
+  uint32_t m_count;
+  float m_minimum;
+  float m_maximum;
+  double m_mean;
+  double m_m2;
+};
+
+#endif
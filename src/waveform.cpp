@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+#include "waveform.hpp"
+
+namespace {
+std::vector<std::string> split(std::string const &text, char delimiter) {
+  std::vector<std::string> fields;
+  std::stringstream sstr(text);
+  std::string field;
+  while (std::getline(sstr, field, delimiter)) {
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+uint8_t parseChannel(std::string const &channel) {
+  int32_t const CHANNEL{std::stoi(channel)};
+  if (CHANNEL < 0 || CHANNEL > 6) {
+    throw std::invalid_argument(
+        "Not supported waveform channel, must be between 0 and 6.");
+  }
+  return static_cast<uint8_t>(CHANNEL);
+}
+}  // namespace
+
+std::vector<WaveformSpec> parseWaveforms(std::string const &waveforms,
+                                         std::string const &stuckFaults) {
+  std::vector<WaveformSpec> specs;
+  for (std::string const &token : split(waveforms, ',')) {
+    if (token.empty()) {
+      continue;
+    }
+    std::vector<std::string> const FIELDS{split(token, ':')};
+    if (FIELDS.size() < 3) {
+      throw std::invalid_argument("Waveform '" + token +
+                                  "' is not <channel>:<shape>:<parameters>.");
+    }
+    WaveformSpec spec;
+    spec.channel = parseChannel(FIELDS[0]);
+    size_t minParameters{1};
+    size_t maxParameters{1};
+    if ("constant" == FIELDS[1]) {
+      spec.shape = WaveformSpec::CONSTANT;
+    } else if ("sine" == FIELDS[1]) {
+      spec.shape = WaveformSpec::SINE;
+      minParameters = maxParameters = 3;
+    } else if ("step" == FIELDS[1]) {
+      spec.shape = WaveformSpec::STEP;
+      minParameters = maxParameters = 3;
+    } else if ("noise" == FIELDS[1]) {
+      spec.shape = WaveformSpec::NOISE;
+      minParameters = maxParameters = 2;
+    } else if ("sag" == FIELDS[1]) {
+      spec.shape = WaveformSpec::SAG;
+      minParameters = 4;
+      maxParameters = 5;
+    } else {
+      throw std::invalid_argument(
+          "Unknown waveform '" + FIELDS[1] +
+          "', must be constant, sine, step, noise or sag.");
+    }
+    if (FIELDS.size() - 2 < minParameters ||
+        FIELDS.size() - 2 > maxParameters) {
+      throw std::invalid_argument("Wrong number of parameters in waveform '" +
+                                  token + "'.");
+    }
+    for (size_t i{2}; i < FIELDS.size(); i++) {
+      spec.parameters.push_back(std::stod(FIELDS[i]));
+    }
+    if ((WaveformSpec::NOISE == spec.shape && spec.parameters[1] < 0.0) ||
+        (WaveformSpec::SAG == spec.shape &&
+         (spec.parameters[3] < 0.0 ||
+          (spec.parameters.size() > 4 &&
+           !(spec.parameters[4] > spec.parameters[3]))))) {
+      throw std::invalid_argument(
+          "Waveform '" + token +
+          "' needs a non-negative deviation or duration, and a period longer "
+          "than its sag.");
+    }
+    for (WaveformSpec const &other : specs) {
+      if (other.channel == spec.channel) {
+        throw std::invalid_argument("Channel " + FIELDS[0] +
+                                    " has more than one waveform.");
+      }
+    }
+    specs.push_back(spec);
+  }
+
+  for (std::string const &token : split(stuckFaults, ',')) {
+    if (token.empty()) {
+      continue;
+    }
+    std::vector<std::string> const FIELDS{split(token, ':')};
+    if (FIELDS.size() < 2 || FIELDS.size() > 3) {
+      throw std::invalid_argument("Stuck-at fault '" + token +
+                                  "' is not <channel>:<at s>[:<code>].");
+    }
+    uint8_t const CHANNEL{parseChannel(FIELDS[0])};
+    bool isFound{false};
+    for (WaveformSpec &spec : specs) {
+      if (spec.channel == CHANNEL) {
+        spec.stuckAt = std::llround(std::stod(FIELDS[1]) * 1.0e6);
+        spec.stuckCode = (FIELDS.size() > 2) ? std::stoi(FIELDS[2]) : -1;
+        isFound = true;
+      }
+    }
+    if (!isFound || (FIELDS.size() > 2 && (std::stoi(FIELDS[2]) < 0 ||
+                                           std::stoi(FIELDS[2]) > 4095))) {
+      throw std::invalid_argument(
+          "Stuck-at fault '" + token +
+          "' needs a channel with a waveform and a code between 0 and 4095.");
+    }
+  }
+  return specs;
+}
+
+int32_t toRaw(AdcChannelConfig const &config, float voltage) noexcept {
+  double const RAW{std::round(
+      static_cast<double>(voltage - config.offset) * 4095.0 /
+      static_cast<double>(config.conversion2Volt))};
+  if (!(RAW > 0.0)) {
+    return 0;
+  }
+  return (RAW < 4095.0) ? static_cast<int32_t>(RAW) : 4095;
+}
+
+Waveform::Waveform(WaveformSpec const &spec, AdcChannelConfig const &config,
+                   uint32_t seed) noexcept
+    : m_spec(spec),
+      m_config(config),
+      m_random{seed + spec.channel},
+      m_normal{0.0, 1.0},
+      m_lastRaw{-1} {}
+
+uint8_t Waveform::channel() const noexcept {
+  return m_spec.channel;
+}
+
+float Waveform::voltage(int64_t timeInMicroseconds) noexcept {
+  std::vector<double> const &P{m_spec.parameters};
+  double const T{static_cast<double>(timeInMicroseconds) * 1.0e-6};
+  double v{P[0]};
+  switch (m_spec.shape) {
+    case WaveformSpec::SINE:
+      v = P[0] + P[1] * std::sin(2.0 * M_PI * P[2] * T);
+      break;
+    case WaveformSpec::STEP:
+      v = (T < P[2]) ? P[0] : P[1];
+      break;
+    case WaveformSpec::NOISE:
+      v = P[0] + P[1] * m_normal(m_random);
+      break;
+    case WaveformSpec::SAG: {
+      double const SINCE{T - P[2]};
+      double const PHASE{(P.size() > 4 && SINCE >= 0.0)
+                             ? std::fmod(SINCE, P[4])
+                             : SINCE};
+      v = (PHASE >= 0.0 && PHASE < P[3]) ? P[1] : P[0];
+      break;
+    }
+    case WaveformSpec::CONSTANT:
+      break;
+  }
+  return static_cast<float>(v);
+}
+
+int32_t Waveform::raw(int64_t timeInMicroseconds) noexcept {
+  bool const IS_STUCK{m_spec.stuckAt >= 0 &&
+                      timeInMicroseconds >= m_spec.stuckAt};
+  if (IS_STUCK && m_spec.stuckCode >= 0) {
+    m_lastRaw = m_spec.stuckCode;
+  } else if (!IS_STUCK || m_lastRaw < 0) {
+    m_lastRaw = toRaw(m_config, voltage(timeInMicroseconds));
+  }
+  return m_lastRaw;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WAVEFORM_HPP
+#define WAVEFORM_HPP
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "adc-sampler.hpp"
+
+/**
+ * Programmable test signal for one channel. Voltages and levels are in volts,
+ * times in seconds since the start of the simulation:
+ *   constant:<V>
+ *   sine:<mean V>:<amplitude V>:<frequency Hz>
+ *   step:<V before>:<V after>:<at s>
+ *   noise:<mean V>:<standard deviation V>
+ *   sag:<nominal V>:<sagged V>:<start s>:<duration s>[:<period s>]
+ * A sag models a brownout; with a period it repeats. Independently, a
+ * stuck-at fault freezes the code of a channel from a given time on, at its
+ * last value or at a given code.
+ */
+struct WaveformSpec {
+  enum Shape { CONSTANT, SINE, STEP, NOISE, SAG };
+
+  uint8_t channel{0};
+  Shape shape{CONSTANT};
+  std::vector<double> parameters{};
+  int64_t stuckAt{-1};  // Microseconds; negative when the channel never sticks.
+  int32_t stuckCode{-1};  // Negative to hold the last code.
+};
+
+/**
+ * Parses comma-separated <channel>:<shape>:<parameters...> waveforms and
+ * <channel>:<at s>[:<code>] stuck-at faults. Throws std::invalid_argument on
+ * malformed input or a fault on a channel without waveform.
+ */
+std::vector<WaveformSpec> parseWaveforms(std::string const &waveforms,
+                                         std::string const &stuckFaults);
+
+/**
+ * Inverse of toVoltage, rounded and clamped to the 12 bits of the converter.
+ */
+int32_t toRaw(AdcChannelConfig const &config, float voltage) noexcept;
+
+/**
+ * Generates the codes of one channel; noise is reproducible for a seed.
+ */
+class Waveform {
+ private:
+  Waveform(Waveform const &) = delete;
+  Waveform &operator=(Waveform const &) = delete;
+  Waveform &operator=(Waveform &&) = delete;
+
+ public:
+  Waveform(WaveformSpec const &spec, AdcChannelConfig const &config,
+           uint32_t seed) noexcept;
+  Waveform(Waveform &&) = default;
+  ~Waveform() = default;
+
+ public:
+  uint8_t channel() const noexcept;
+  float voltage(int64_t timeInMicroseconds) noexcept;
+  int32_t raw(int64_t timeInMicroseconds) noexcept;
+
+ private:
+  WaveformSpec m_spec;
+  AdcChannelConfig m_config;
+  std::mt19937 m_random;
+  std::normal_distribution<double> m_normal;
+  int32_t m_lastRaw;
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include <cmath>
+#include <iostream>
+
+#include "test-runner.hpp"
+
+namespace {
+uint32_t g_failures{0};
+}  // namespace
+
+namespace test {
+std::vector<TestCase> &testCases() noexcept {
+  static std::vector<TestCase> cases;
+  return cases;
+}
+
+void fail(char const *file, int32_t line, char const *expression) noexcept {
+  std::cerr << file << ":" << line << ": failed: " << expression
+            << std::endl;
+  g_failures++;
+}
+
+bool isClose(double a, double b, double tolerance) noexcept {
+  return std::fabs(a - b) <= tolerance;
+}
+
+// A fresh directory for the files a test case writes.
+std::string temporaryDirectory() noexcept {
+  char path[] = "/tmp/adc-bbblue-test-XXXXXX";
+  char const *dir{::mkdtemp(path)};
+  return (nullptr != dir) ? dir : "";
+}
+
+Registrar::Registrar(char const *name, void (*function)()) noexcept {
+  testCases().push_back(TestCase{name, function});
+}
+}  // namespace test
+
+int32_t main(int32_t argc, char **argv) {
+  // An optional argument selects the test cases whose name contains it.
+  std::string const FILTER{(argc > 1) ? argv[1] : ""};
+  uint32_t count{0};
+  uint32_t failedCases{0};
+  for (auto const &testCase : test::testCases()) {
+    if (std::string(testCase.name).find(FILTER) == std::string::npos) {
+      continue;
+    }
+    uint32_t const FAILURES_BEFORE{g_failures};
+    testCase.function();
+    count++;
+    if (g_failures != FAILURES_BEFORE) {
+      std::cerr << testCase.name << " failed." << std::endl;
+      failedCases++;
+    }
+  }
+  std::cout << count << " test cases, " << failedCases << " failed."
+            << std::endl;
+  return (0 == failedCases && count > 0) ? 0 : 1;
+}
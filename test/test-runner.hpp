@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEST_RUNNER_HPP
+#define TEST_RUNNER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal test runner: TEST_CASE registers a function that the runner calls,
+ * CHECK records a failed expression and carries on, REQUIRE records it and
+ * leaves the test case. The runner exits non-zero when any check failed.
+ */
+namespace test {
+struct TestCase {
+  char const *name;
+  void (*function)();
+};
+
+std::vector<TestCase> &testCases() noexcept;
+void fail(char const *file, int32_t line, char const *expression) noexcept;
+bool isClose(double a, double b, double tolerance = 1.0e-6) noexcept;
+std::string temporaryDirectory() noexcept;
+
+class Registrar {
+ public:
+  Registrar(char const *name, void (*function)()) noexcept;
+};
+}  // namespace test
+
+#define TEST_CASE(name)                                                      \
+  static void name();                                                        \
+  static test::Registrar const name##Registrar{#name, name};                 \
+  static void name()
+
+#define CHECK(expression)                                                    \
+  do {                                                                       \
+    if (!(expression)) {                                                     \
+      test::fail(__FILE__, __LINE__, #expression);                           \
+    }                                                                        \
+  } while (false)
+
+#define REQUIRE(expression)                                                  \
+  do {                                                                       \
+    if (!(expression)) {                                                     \
+      test::fail(__FILE__, __LINE__, #expression);                           \
+      return;                                                                \
+    }                                                                        \
+  } while (false)
+
+#endif
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "acquisition-control.hpp"
+#include "test-runner.hpp"
+
+namespace {
+std::unique_ptr<AdcSampler> openSampler(
+    std::vector<AdcChannelConfig> const &configs) {
+  return std::unique_ptr<AdcSampler>(new AdcSampler("/nonexistent", configs));
+}
+
+// Two channels at 10 Hz, with summaries and health kept per channel.
+void setUp(AcquisitionState &state) {
+  state.configs = parseChannelConfigs("0,1", "10", "");
+  state.sampler = openSampler(state.configs);
+  state.outputs.assign(state.configs.size(), 0);
+  state.health.resize(state.configs.size());
+  state.alarms.resize(state.configs.size());
+  state.summaryWindow = 1000000;
+  for (size_t i{0}; i < state.configs.size(); i++) {
+    state.statistics.emplace_back(state.summaryWindow);
+  }
+}
+}  // namespace
+
+TEST_CASE(acquisitionControlAppliesMergedRequestsOnce) {
+  AcquisitionState state;
+  setUp(state);
+  DeadlineScheduler scheduler{100000000};
+  AcquisitionControl control{state, scheduler, openSampler, false, false};
+  opendlv::device::adc::AcquisitionRequest first;
+  first.frequency(50.0f);
+  first.deadband(0.01f);
+  opendlv::device::adc::AcquisitionRequest second;
+  second.frequency(100.0f);
+  second.batch(16);
+  std::string reason;
+  CHECK(control.request(first, reason));
+  CHECK(control.request(second, reason));
+  REQUIRE(control.isPending());
+  // Nothing changes before the next tick applies the request.
+  CHECK(100000000 == scheduler.period());
+  CHECK(state.deadbands.empty());
+
+  control.apply([](size_t) {});
+  CHECK(!control.isPending());
+  CHECK(10000000 == scheduler.period());
+  CHECK(2 == state.deadbands.size());
+  CHECK(test::isClose(state.deadband, 0.01));
+  CHECK(2 == state.batches.size());
+  CHECK(16 == state.batchSize);
+
+  // A batch size of 1 turns batching off, a negative deadband the deadband.
+  opendlv::device::adc::AcquisitionRequest off;
+  off.batch(1);
+  off.deadband(-1.0f);
+  CHECK(control.request(off, reason));
+  control.apply([](size_t) {});
+  CHECK(state.batches.empty());
+  CHECK(state.deadbands.empty());
+  CHECK(10000000 == scheduler.period());
+}
+
+TEST_CASE(acquisitionControlRejectsInvalidRequests) {
+  AcquisitionState state;
+  setUp(state);
+  DeadlineScheduler scheduler{100000000};
+  AcquisitionControl control{state, scheduler, openSampler, false, false};
+  float const NAN_VALUE{std::numeric_limits<float>::quiet_NaN()};
+  float const INFINITE{std::numeric_limits<float>::infinity()};
+  std::string reason;
+
+  opendlv::device::adc::AcquisitionRequest request;
+  request.frequency(NAN_VALUE);
+  CHECK(!control.request(request, reason));
+  request.frequency(1.0e9f);
+  CHECK(!control.request(request, reason));
+  request.frequency(-1.0f);
+  CHECK(!control.request(request, reason));
+
+  request = opendlv::device::adc::AcquisitionRequest{};
+  request.heartbeat(INFINITE);
+  CHECK(!control.request(request, reason));
+  request.heartbeat(-1.0f);
+  CHECK(!control.request(request, reason));
+
+  request = opendlv::device::adc::AcquisitionRequest{};
+  request.deadband(NAN_VALUE);
+  CHECK(!control.request(request, reason));
+  request.deadband(INFINITE);
+  CHECK(!control.request(request, reason));
+
+  request = opendlv::device::adc::AcquisitionRequest{};
+  request.batchMs(NAN_VALUE);
+  CHECK(!control.request(request, reason));
+  request.batchMs(1.0e9f);
+  CHECK(!control.request(request, reason));
+
+  request = opendlv::device::adc::AcquisitionRequest{};
+  request.channels("0,9");
+  CHECK(!control.request(request, reason));
+  CHECK(!reason.empty());
+
+  CHECK(!control.isPending());
+  CHECK(100000000 == scheduler.period());
+}
+
+TEST_CASE(acquisitionControlKeepsFixedRateAndChannels) {
+  AcquisitionState state;
+  setUp(state);
+  DeadlineScheduler scheduler{100000000};
+  std::string reason;
+  opendlv::device::adc::AcquisitionRequest rate;
+  rate.frequency(50.0f);
+  opendlv::device::adc::AcquisitionRequest channels;
+  channels.channels("2");
+  opendlv::device::adc::AcquisitionRequest deadband;
+  deadband.deadband(0.1f);
+
+  // Buffered capture fixes both, shared memory only the channels.
+  AcquisitionControl buffered{state, scheduler, openSampler, true, true};
+  CHECK(!buffered.request(rate, reason));
+  CHECK(!buffered.request(channels, reason));
+  CHECK(buffered.request(deadband, reason));
+
+  AcquisitionControl shared{state, scheduler, openSampler, false, true};
+  CHECK(shared.request(rate, reason));
+  CHECK(!shared.request(channels, reason));
+}
+
+TEST_CASE(acquisitionControlRemapsChannelState) {
+  AcquisitionState state;
+  setUp(state);
+  state.alarmRules = parseAlarmRules("2:3.0");
+  state.statistics[1].add(1.5f, 0);
+  DeadlineScheduler scheduler{100000000};
+  AcquisitionControl control{state, scheduler, openSampler, false, false};
+  opendlv::device::adc::AcquisitionRequest request;
+  request.channels("1,2");
+  request.ids("20");
+  std::string reason;
+  REQUIRE(control.request(request, reason));
+  // The channels are opened on arrival, but sampled from the next tick on.
+  CHECK(2 == state.configs.size());
+  CHECK(0 == state.configs[0].channel);
+
+  std::vector<size_t> retired;
+  control.apply([&retired](size_t index) { retired.push_back(index); });
+  REQUIRE(1 == retired.size());
+  CHECK(0 == retired[0]);
+  REQUIRE(2 == state.configs.size());
+  CHECK(1 == state.configs[0].channel);
+  CHECK(20 == state.configs[0].senderStamp);
+  CHECK(2 == state.configs[1].channel);
+  REQUIRE(state.sampler != nullptr);
+  CHECK(2 == state.sampler->size());
+  CHECK(2 == state.outputs.size());
+  CHECK(2 == state.health.size());
+  // Channel 1 keeps its window, channel 2 starts with an empty one and gets
+  // its alarm rule.
+  REQUIRE(2 == state.statistics.size());
+  CHECK(1 == state.statistics[0].count());
+  CHECK(0 == state.statistics[1].count());
+  REQUIRE(2 == state.alarms.size());
+  CHECK(state.alarms[0].empty());
+  CHECK(1 == state.alarms[1].size());
+}
+
+TEST_CASE(acquisitionControlFollowsLeases) {
+  AcquisitionState state;
+  setUp(state);
+  DeadlineScheduler scheduler{1000000000};
+  AcquisitionControl control{state, scheduler, openSampler, false, false};
+  opendlv::device::adc::SamplingLease request;
+  request.channel(1);
+  request.frequency(100.0f);
+  request.duration(1.0f);
+  std::string reason;
+  CHECK(!control.lease(7, request, 0, reason));
+  control.enableLeases(1.0f, 4);
+  REQUIRE(control.hasLeases());
+  CHECK(control.lease(7, request, 0, reason));
+  CHECK(1 == control.leases());
+  control.apply([](size_t) {});
+  CHECK(10000000 == scheduler.period());
+
+  // Only sampled channels may be leased.
+  request.channel(5);
+  CHECK(!control.lease(8, request, 0, reason));
+  CHECK(1 == control.leases());
+
+  // A new rate from a request is the idle rate, which the lease still beats.
+  opendlv::device::adc::AcquisitionRequest idle;
+  idle.frequency(2.0f);
+  CHECK(control.request(idle, reason));
+  control.apply([](size_t) {});
+  CHECK(10000000 == scheduler.period());
+
+  control.expireLeases(999999999);
+  CHECK(!control.isPending());
+  control.expireLeases(1000000000);
+  CHECK(0 == control.leases());
+  control.apply([](size_t) {});
+  CHECK(500000000 == scheduler.period());
+}
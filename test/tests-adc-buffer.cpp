@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "adc-buffer.hpp"
+#include "test-runner.hpp"
+
+namespace {
+void writeFile(std::string const &path, std::string const &content) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out << content;
+}
+}  // namespace
+
+TEST_CASE(adcBufferParsesScanElementTypes) {
+  AdcScanElement element;
+  CHECK(parseScanElementType("be:s14/32>>2", element));
+  CHECK(element.isBigEndian);
+  CHECK(element.isSigned);
+  CHECK(14 == element.realBits);
+  CHECK(32 == element.storageBits);
+  CHECK(2 == element.shift);
+  CHECK(!parseScanElementType("le:u12/24>>0", element));
+  CHECK(!parseScanElementType("le:u12/8>>0", element));
+}
+
+TEST_CASE(adcBufferPadsScansToTheLargestElement) {
+  std::string const DIR{test::temporaryDirectory()};
+  REQUIRE(!DIR.empty());
+  REQUIRE(0 == ::mkdir((DIR + "/scan_elements").c_str(), 0700));
+  writeFile(DIR + "/scan_elements/in_voltage0_type", "le:u32/32>>0\n");
+  writeFile(DIR + "/scan_elements/in_voltage0_index", "0\n");
+  writeFile(DIR + "/scan_elements/in_voltage1_type", "le:u12/16>>0\n");
+  writeFile(DIR + "/scan_elements/in_voltage1_index", "1\n");
+  // Two scans of a 32-bit and a 16-bit element, padded from 6 to 8 bytes.
+  std::string const SCANS{
+      "\x01\x00\x01\x00\xff\x0f\x00\x00"
+      "\x02\x00\x00\x00\x34\x02\x00\x00",
+      16};
+  writeFile(DIR + "/scans", SCANS);
+
+  AdcBuffer buffer{DIR, DIR + "/scans", std::vector<uint8_t>{0, 1}, 1000.0f,
+                   4};
+  REQUIRE(buffer.isOpen());
+  CHECK(8 == buffer.scanSize());
+  CHECK(2 == buffer.read());
+  CHECK(0x10001 == buffer.raw(0, 0));
+  CHECK(0xfff == buffer.raw(0, 1));
+  CHECK(2 == buffer.raw(1, 0));
+  CHECK(0x234 == buffer.raw(1, 1));
+  for (char const *name :
+       {"/scan_elements/in_voltage0_type", "/scan_elements/in_voltage0_index",
+        "/scan_elements/in_voltage1_type", "/scan_elements/in_voltage1_index",
+        "/scans"}) {
+    ::unlink((DIR + name).c_str());
+  }
+  ::rmdir((DIR + "/scan_elements").c_str());
+  ::rmdir(DIR.c_str());
+}
+
+TEST_CASE(adcBufferWritesAndReadsBackTheSamplingFrequency) {
+  std::string const DIR{test::temporaryDirectory()};
+  REQUIRE(!DIR.empty());
+  writeFile(DIR + "/scans", std::string(4, '\0'));
+  {
+    AdcBuffer buffer{DIR, DIR + "/scans", std::vector<uint8_t>{0}, 250.0f, 4};
+    CHECK(test::isClose(250.0f, buffer.samplingFrequency()));
+  }
+  writeFile(DIR + "/sampling_frequency", "0\n");
+  {
+    AdcBuffer buffer{DIR, DIR + "/scans", std::vector<uint8_t>{0}, 2.5f, 4};
+    CHECK(test::isClose(2.5f, buffer.samplingFrequency()));
+    std::ifstream in(DIR + "/sampling_frequency");
+    float written{0.0f};
+    in >> written;
+    CHECK(test::isClose(2.5f, written));
+  }
+  ::unlink((DIR + "/sampling_frequency").c_str());
+  ::unlink((DIR + "/scans").c_str());
+  ::rmdir(DIR.c_str());
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "adc-channel.hpp"
+#include "test-runner.hpp"
+
+namespace {
+void writeFile(std::string const &path, std::string const &content) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out << content;
+}
+}  // namespace
+
+TEST_CASE(adcChannelParsesRawValues) {
+  int32_t value{0};
+  CHECK(parseRawAdcValue(" 4095\n", 6, value));
+  CHECK(4095 == value);
+  CHECK(!parseRawAdcValue("\n", 1, value));
+  CHECK(!parseRawAdcValue("99999999999\n", 12, value));
+}
+
+TEST_CASE(adcChannelOpensANodeThatAppearsLater) {
+  std::string const DIR{test::temporaryDirectory()};
+  REQUIRE(!DIR.empty());
+  std::string const PATH{DIR + "/in_voltage0_raw"};
+  AdcChannel channel{PATH};
+  CHECK(!channel.isOpen());
+  int32_t value{0};
+  CHECK(!channel.read(value));
+  CHECK(ENOENT == channel.lastError());
+
+  writeFile(PATH, "1234\n");
+  CHECK(channel.read(value));
+  CHECK(channel.isOpen());
+  CHECK(1234 == value);
+  ::unlink(PATH.c_str());
+  ::rmdir(DIR.c_str());
+}
+
+TEST_CASE(adcChannelReopensAfterRepeatedErrors) {
+  std::string const DIR{test::temporaryDirectory()};
+  REQUIRE(!DIR.empty());
+  std::string const PATH{DIR + "/in_voltage0_raw"};
+  writeFile(PATH, "garbage\n");
+  AdcChannel channel{PATH};
+  REQUIRE(channel.isOpen());
+
+  // The open descriptor keeps reading the replaced node until it is closed.
+  writeFile(DIR + "/replacement", "42\n");
+  REQUIRE(0 == std::rename((DIR + "/replacement").c_str(), PATH.c_str()));
+  int32_t value{0};
+  for (uint32_t i{0}; i < AdcChannel::MAX_CONSECUTIVE_ERRORS; i++) {
+    CHECK(!channel.read(value));
+    CHECK(EBADMSG == channel.lastError());
+  }
+  CHECK(!channel.isOpen());
+  CHECK(channel.read(value));
+  CHECK(42 == value);
+  ::unlink(PATH.c_str());
+  ::rmdir(DIR.c_str());
+}
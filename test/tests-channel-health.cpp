@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "channel-health.hpp"
+#include "cluon-complete.hpp"
+#include "od4-sender.hpp"
+#include "opendlv-device-adc-bbblue-message-set.hpp"
+#include "opendlv-standard-message-set.hpp"
+#include "test-runner.hpp"
+
+TEST_CASE(channelHealthReportsAFailingChannelNonZero) {
+  ChannelHealth health;
+  CHECK(0 == health.statusCode());
+  // Windows with some, then only failed reads.
+  health.addRead(0);
+  health.addRead(EIO);
+  health.addRead(0);
+  CHECK(EIO == health.statusCode());
+  health.clearWindow();
+  for (int32_t i{0}; i < 3; i++) {
+    health.addRead(ENODEV);
+    CHECK(ENODEV == health.statusCode());
+  }
+  health.clearWindow();
+  health.addRead(ENODEV);
+  CHECK(0 != health.statusCode());
+  // Healthy again once a whole window read fine.
+  health.clearWindow();
+  health.addRead(0);
+  CHECK(0 == health.statusCode());
+  CHECK(ENODEV == health.lastError());
+}
+
+TEST_CASE(channelHealthIsNotOverwrittenByTheTimingSummary) {
+  // Health and timing summary go out under the same sender stamp; a consumer
+  // keeping the latest status per sender must still see the failure.
+  ChannelHealth health;
+  health.addRead(EIO);
+  uint32_t const SENDER_STAMP{0};
+  opendlv::system::SignalStatusMessage signalStatus;
+  signalStatus.code(health.statusCode());
+  opendlv::device::adc::TimingSummary timingSummary;
+  timingSummary.description("period[ns]: n=0");
+  std::vector<std::string> const SENT{
+      Od4Sender::serialize(signalStatus, cluon::time::now(), SENDER_STAMP),
+      Od4Sender::serialize(timingSummary, cluon::time::now(), SENDER_STAMP)};
+
+  std::map<uint32_t, int32_t> latestCodes;
+  for (auto const &data : SENT) {
+    std::stringstream in(data);
+    auto result = cluon::extractEnvelope(in);
+    REQUIRE(result.first);
+    cluon::data::Envelope envelope{std::move(result.second)};
+    if (opendlv::system::SignalStatusMessage::ID() == envelope.dataType()) {
+      uint32_t const STAMP{envelope.senderStamp()};
+      latestCodes[STAMP] =
+          cluon::extractMessage<opendlv::system::SignalStatusMessage>(
+              std::move(envelope))
+              .code();
+    }
+  }
+  REQUIRE(1 == latestCodes.size());
+  CHECK(EIO == latestCodes[SENDER_STAMP]);
+}
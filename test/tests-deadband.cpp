@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <utility>
+
+#include "deadband.hpp"
+#include "test-runner.hpp"
+
+TEST_CASE(deadbandPassesFirstSampleAndLargeChanges) {
+  DeadbandFilter filter{0.1f, 0};
+  CHECK(filter.pass(12.0f, 0));
+  CHECK(!filter.pass(12.05f, 1000));
+  CHECK(!filter.pass(11.95f, 2000));
+  CHECK(filter.pass(12.2f, 3000));
+  // Changes are measured from the last passed voltage, so drift passes.
+  CHECK(!filter.pass(12.25f, 4000));
+  CHECK(filter.pass(12.31f, 5000));
+  CHECK(filter.pass(12.0f, 6000));
+  CHECK(4 == filter.published());
+  CHECK(3 == filter.suppressed());
+}
+
+TEST_CASE(deadbandPassesHeartbeats) {
+  DeadbandFilter filter{1.0f, 10000};
+  CHECK(filter.pass(5.0f, 0));
+  CHECK(!filter.pass(5.0f, 9999));
+  CHECK(filter.pass(5.0f, 10000));
+  CHECK(!filter.pass(5.0f, 19999));
+  CHECK(filter.pass(5.0f, 20000));
+}
+
+TEST_CASE(deadbandKeepsStateWhenMoved) {
+  DeadbandFilter filter{1.0f, 0};
+  CHECK(filter.pass(5.0f, 0));
+  CHECK(!filter.pass(5.5f, 1000));
+  DeadbandFilter moved{std::move(filter)};
+  CHECK(!moved.pass(5.5f, 2000));
+  CHECK(1 == moved.published());
+  CHECK(2 == moved.suppressed());
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <limits>
+
+#include "deadline-scheduler.hpp"
+#include "test-runner.hpp"
+
+TEST_CASE(deadlineSchedulerRoundsPeriodsToTheNearestNanosecond) {
+  CHECK(3333333 == DeadlineScheduler::periodFromFrequency(300.0f));
+  CHECK(142857143 == DeadlineScheduler::periodFromFrequency(7.0f));
+  CHECK(1000000 == DeadlineScheduler::periodFromFrequency(1000.0f));
+  CHECK(1000000000 == DeadlineScheduler::periodFromFrequency(1.0f));
+}
+
+TEST_CASE(deadlineSchedulerKeepsPeriodsWithinBounds) {
+  int64_t const MIN_PERIOD{1000000000 / DeadlineScheduler::MAX_FREQUENCY};
+  CHECK(MIN_PERIOD == DeadlineScheduler::periodFromFrequency(
+                          static_cast<float>(DeadlineScheduler::MAX_FREQUENCY)));
+  CHECK(MIN_PERIOD == DeadlineScheduler::periodFromFrequency(1.0e9f));
+  CHECK(MIN_PERIOD == DeadlineScheduler::periodFromFrequency(
+                          std::numeric_limits<float>::infinity()));
+
+  // As from --stats-period=3600, and from periods far longer than that,
+  // whose period in nanoseconds would not fit an int64_t.
+  int64_t const HOUR{DeadlineScheduler::periodFromFrequency(1.0f / 3600.0f)};
+  CHECK(HOUR <= DeadlineScheduler::MAX_PERIOD);
+  CHECK(HOUR > DeadlineScheduler::MAX_PERIOD - 1000000);
+  CHECK(DeadlineScheduler::MAX_PERIOD ==
+        DeadlineScheduler::periodFromFrequency(1.0e-30f));
+  CHECK(DeadlineScheduler::MAX_PERIOD ==
+        DeadlineScheduler::periodFromFrequency(
+            std::numeric_limits<float>::denorm_min()));
+
+  // Frequencies that are not positive fall back to 1 Hz.
+  CHECK(1000000000 == DeadlineScheduler::periodFromFrequency(0.0f));
+  CHECK(1000000000 == DeadlineScheduler::periodFromFrequency(-5.0f));
+  CHECK(1000000000 == DeadlineScheduler::periodFromFrequency(
+                          std::numeric_limits<float>::quiet_NaN()));
+}
+
+TEST_CASE(deadlineSchedulerStaysOnTheGridAfterAnOverrun) {
+  int64_t const PERIOD{1000000};
+  DeadlineScheduler scheduler{PERIOD};
+  int64_t const START{scheduler.nextDeadline() - PERIOD};
+  // The first deadline is overrun by two and a half periods.
+  while (DeadlineScheduler::now() < START + 7 * PERIOD / 2) {
+  }
+  scheduler.skipMissedDeadlines();
+  uint64_t const MISSED{scheduler.missedDeadlines()};
+  CHECK(MISSED >= 2);
+  CHECK(START + static_cast<int64_t>(1 + MISSED) * PERIOD ==
+        scheduler.nextDeadline());
+
+  // The deadline left is less than a period late and is served right away.
+  REQUIRE(scheduler.waitForNextDeadline());
+  CHECK(1 == scheduler.ticks());
+  CHECK(0 == (scheduler.nextDeadline() - START) % PERIOD);
+  CHECK(START + static_cast<int64_t>(2 + scheduler.missedDeadlines()) *
+                    PERIOD ==
+        scheduler.nextDeadline());
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <string>
+
+#include "histogram.hpp"
+#include "test-runner.hpp"
+
+TEST_CASE(logHistogramGivesSmallValuesABucketEach) {
+  for (uint64_t value{0}; value < 64; value++) {
+    CHECK(LogHistogram::indexOf(value) == value);
+    CHECK(LogHistogram::lowerBound(value) == value);
+    CHECK(LogHistogram::upperBound(value) == value);
+  }
+}
+
+TEST_CASE(logHistogramSplitsOctavesIntoLinearSubBuckets) {
+  // 64 to 127 is split into 32 buckets of 2, 1024 to 2047 into 32 of 32.
+  CHECK(LogHistogram::indexOf(64) == 64);
+  CHECK(LogHistogram::indexOf(65) == 64);
+  CHECK(LogHistogram::indexOf(66) == 65);
+  CHECK(LogHistogram::indexOf(127) == 95);
+  CHECK(LogHistogram::indexOf(128) == 96);
+  CHECK(LogHistogram::lowerBound(LogHistogram::indexOf(1000)) == 992);
+  CHECK(LogHistogram::upperBound(LogHistogram::indexOf(1000)) == 1007);
+  CHECK(LogHistogram::lowerBound(LogHistogram::indexOf(3333333)) == 3276800);
+  CHECK(LogHistogram::upperBound(LogHistogram::indexOf(3333333)) == 3342335);
+}
+
+TEST_CASE(logHistogramBucketsAreContiguous) {
+  for (size_t i{0}; i + 1 < LogHistogram::BUCKETS; i++) {
+    REQUIRE(LogHistogram::upperBound(i) + 1 == LogHistogram::lowerBound(i + 1));
+    REQUIRE(LogHistogram::indexOf(LogHistogram::lowerBound(i)) == i);
+    REQUIRE(LogHistogram::indexOf(LogHistogram::upperBound(i)) == i);
+  }
+  CHECK(LogHistogram::indexOf(UINT64_MAX) == LogHistogram::BUCKETS - 1);
+  CHECK(LogHistogram::upperBound(LogHistogram::BUCKETS - 1) == UINT64_MAX);
+}
+
+TEST_CASE(logHistogramBucketsAreNarrowerThanAThirtySecondOfTheirValues) {
+  for (size_t i{64}; i + 1 < LogHistogram::BUCKETS; i++) {
+    uint64_t const WIDTH{LogHistogram::upperBound(i) -
+                         LogHistogram::lowerBound(i) + 1};
+    REQUIRE(WIDTH * 32 <= LogHistogram::lowerBound(i));
+  }
+}
+
+TEST_CASE(logHistogramClampsNegativeValuesToZero) {
+  LogHistogram histogram;
+  histogram.record(-5);
+  CHECK(histogram.bucket(0) == 1);
+  CHECK(histogram.count() == 1);
+  CHECK(histogram.sum() == 0);
+  CHECK(histogram.max() == 0);
+}
+
+TEST_CASE(logHistogramReportsPercentilesOfKnownInputs) {
+  LogHistogram histogram;
+  // 1 to 1000 µs in ns, so the p-th percentile is p * 10 µs.
+  for (int64_t value{1}; value <= 1000; value++) {
+    histogram.record(value * 1000);
+  }
+  CHECK(histogram.count() == 1000);
+  CHECK(histogram.max() == 1000000);
+  CHECK(test::isClose(static_cast<double>(histogram.percentile(0.5)),
+                      500000.0, 500000.0 / 32));
+  CHECK(histogram.percentile(0.5) >= 501000);
+  CHECK(test::isClose(static_cast<double>(histogram.percentile(0.99)),
+                      990000.0, 990000.0 / 32));
+  CHECK(histogram.percentile(0.99) >= 991000);
+  CHECK(histogram.percentile(1.0) == 1000000);
+}
+
+TEST_CASE(logHistogramTellsApartCloseLatencies) {
+  // Power-of-two buckets reported both as 512.
+  LogHistogram first;
+  LogHistogram second;
+  for (int32_t i{0}; i < 100; i++) {
+    first.record(300);
+    second.record(500);
+  }
+  CHECK(first.percentile(0.99) >= 300);
+  CHECK(first.percentile(0.99) < 310);
+  CHECK(second.percentile(0.99) >= 500);
+  CHECK(second.percentile(0.99) < 510);
+}
+
+TEST_CASE(logHistogramSummaryAndClear) {
+  LogHistogram histogram;
+  histogram.record(10);
+  histogram.record(30);
+  CHECK(histogram.summary() ==
+        "n=2 mean=20 p50<=30 p99<=30 p999<=30 max=30");
+  histogram.clear();
+  CHECK(histogram.count() == 0);
+  CHECK(histogram.bucket(LogHistogram::indexOf(30)) == 0);
+  CHECK(histogram.summary() == "n=0 mean=0 p50<=0 p99<=0 p999<=0 max=0");
+}
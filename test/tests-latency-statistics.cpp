@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+
+#include "latency-statistics.hpp"
+#include "test-runner.hpp"
+
+TEST_CASE(latencyStatisticsCountsGapsInSampleTimes) {
+  LatencyStatistics statistics;
+  // 10 ms apart with a little jitter; samples 4, 7 and 8 are missing.
+  int64_t const TIMES[]{0, 10100, 19900, 30000, 50000, 60100, 90000};
+  for (int64_t time : TIMES) {
+    statistics.addMessage(time + 500);
+    statistics.addSample(time, time + 100, time + 500);
+  }
+  CHECK(7 == statistics.samples());
+  CHECK(3 == statistics.missingSamples());
+  CHECK(std::string::npos !=
+        statistics.summary().find("missing-samples=3"));
+  CHECK(std::string::npos !=
+        statistics.summary().find("age-at-receive[us]: n=7 mean=500"));
+
+  // Gaps are also counted across report windows.
+  statistics.clear();
+  CHECK(0 == statistics.samples());
+  statistics.addSample(110000, 110100, 110500);
+  CHECK(1 == statistics.missingSamples());
+}
+
+TEST_CASE(latencyStatisticsCountsMissingMessagesFromSequenceNumbers) {
+  LatencyStatistics statistics;
+  uint32_t const SEQUENCE_NUMBERS[]{0xfffffffeu, 0xffffffffu, 1, 0, 2};
+  for (uint32_t sequenceNumber : SEQUENCE_NUMBERS) {
+    statistics.addSequenceNumber(sequenceNumber);
+  }
+  CHECK(std::string::npos != statistics.summary().find(
+                                 "missing-messages=1 reordered=1"));
+}
+
+TEST_CASE(latencyStatisticsCountsNegativeAges) {
+  LatencyStatistics statistics;
+  statistics.addSample(1000, 900, 1200);
+  CHECK(std::string::npos !=
+        statistics.summary().find("negative-ages=1"));
+}
+
+TEST_CASE(latencyStatisticsReportsAgePercentilesInMicroseconds) {
+  LatencyStatistics statistics;
+  // Ages at receive of 1 to 1000 µs, so the p-th percentile is p * 10 µs;
+  // every sample was sent 100 µs after it was taken.
+  for (int64_t age{1}; age <= 1000; age++) {
+    int64_t const SAMPLE_TIME{age * 10000};
+    statistics.addSample(SAMPLE_TIME, SAMPLE_TIME + 100, SAMPLE_TIME + age);
+  }
+  LogHistogram const &RECEIVED_AGE{statistics.receivedAge()};
+  CHECK(1000 == RECEIVED_AGE.count());
+  CHECK(1000 == RECEIVED_AGE.max());
+  CHECK(RECEIVED_AGE.percentile(0.5) >= 501);
+  CHECK(RECEIVED_AGE.percentile(0.5) <= 501 + 501 / 32);
+  CHECK(RECEIVED_AGE.percentile(0.99) >= 991);
+  CHECK(RECEIVED_AGE.percentile(0.99) <= 1000);
+  CHECK(100 == statistics.sentAge().percentile(0.5));
+  CHECK(std::string::npos !=
+        statistics.summary().find("age-at-send[us]: n=1000 mean=100 "
+                                  "p50<=100 p99<=100 p999<=100 max=100"));
+}
+
+TEST_CASE(latencyStatisticsTellsApartCloseAgePercentiles) {
+  // Power-of-two buckets reported both medians as 512; one late sample
+  // keeps the maximum from capping the reported percentile.
+  LatencyStatistics first;
+  LatencyStatistics second;
+  for (int64_t i{0}; i < 100; i++) {
+    int64_t const LATE{(99 == i) ? 700 : 0};
+    first.addSample(i * 10000, i * 10000, i * 10000 + 300 + LATE);
+    second.addSample(i * 10000, i * 10000, i * 10000 + 500 + LATE);
+  }
+  CHECK(std::string::npos !=
+        first.summary().find("age-at-receive[us]: n=100 mean=307 p50<=303 "));
+  CHECK(std::string::npos !=
+        second.summary().find("age-at-receive[us]: n=100 mean=507 p50<=503 "));
+}
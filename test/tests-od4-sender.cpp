@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <string>
+
+#include "cluon-complete.hpp"
+#include "od4-sender.hpp"
+#include "opendlv-standard-message-set.hpp"
+#include "test-runner.hpp"
+
+namespace {
+cluon::data::Envelope decode(std::string const &data) {
+  std::stringstream in(data);
+  auto result = cluon::extractEnvelope(in);
+  return std::move(result.second);
+}
+}  // namespace
+
+TEST_CASE(od4SenderKeepsAGivenSampleTimeStamp) {
+  opendlv::system::SignalStatusMessage message;
+  message.code(5).description("health");
+  cluon::data::TimeStamp sampleTime;
+  sampleTime.seconds(1600000000).microseconds(123);
+  cluon::data::Envelope envelope{
+      decode(Od4Sender::serialize(message, sampleTime, 7))};
+  CHECK(opendlv::system::SignalStatusMessage::ID() == envelope.dataType());
+  CHECK(7 == envelope.senderStamp());
+  CHECK(1600000000 == envelope.sampleTimeStamp().seconds());
+  CHECK(123 == envelope.sampleTimeStamp().microseconds());
+  auto const DECODED{
+      cluon::extractMessage<opendlv::system::SignalStatusMessage>(
+          std::move(envelope))};
+  CHECK(5 == DECODED.code());
+  CHECK("health" == DECODED.description());
+}
+
+TEST_CASE(od4SenderReplacesAnUnsetSampleTimeStampLikeOd4Session) {
+  opendlv::system::SignalStatusMessage message;
+  cluon::data::Envelope const ENVELOPE{decode(
+      Od4Sender::serialize(message, cluon::data::TimeStamp{}, 0))};
+  CHECK(0 != ENVELOPE.sent().seconds());
+  CHECK(ENVELOPE.sent().seconds() == ENVELOPE.sampleTimeStamp().seconds());
+  CHECK(ENVELOPE.sent().microseconds() ==
+        ENVELOPE.sampleTimeStamp().microseconds());
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "publisher-thread.hpp"
+#include "test-runner.hpp"
+
+namespace {
+// Waits until the publisher thread has called the drained delegate as often.
+bool waitFor(std::atomic<uint32_t> const &count, uint32_t expected) {
+  for (int32_t i{0}; i < 1000 && count.load() < expected; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return count.load() >= expected;
+}
+}  // namespace
+
+TEST_CASE(publisherThreadDrainsInOrder) {
+  SampleRing ring{16, OverflowPolicy::DropOldest};
+  std::atomic<int64_t> last{0};
+  std::atomic<bool> isOrdered{true};
+  std::atomic<uint32_t> drained{0};
+  PublisherThread publisher{ring,
+                            [&last, &isOrdered](SampleRecord const &record) {
+                              if (record.sampleTime != last.load() + 1) {
+                                isOrdered.store(false);
+                              }
+                              last.store(record.sampleTime);
+                            },
+                            [&drained]() { drained++; }};
+  REQUIRE(publisher.isRunning());
+  for (int64_t i{1}; i <= 10; i++) {
+    SampleRecord record;
+    record.sampleTime = i;
+    ring.push(record);
+  }
+  uint32_t const BEFORE{drained.load()};
+  publisher.notify();
+  CHECK(waitFor(drained, BEFORE + 1));
+  publisher.stop();
+  CHECK(10 == last.load());
+  CHECK(isOrdered.load());
+}
+
+TEST_CASE(publisherThreadEndsTicksWithoutSamples) {
+  // A tick without samples still ends with the drained delegate, which
+  // flushes batches by their age.
+  SampleRing ring{16, OverflowPolicy::DropOldest};
+  std::atomic<uint32_t> drained{0};
+  PublisherThread publisher{ring, [](SampleRecord const &) {},
+                            [&drained]() { drained++; }};
+  REQUIRE(publisher.isRunning());
+  uint32_t const BEFORE{drained.load()};
+  publisher.notify();
+  CHECK(waitFor(drained, BEFORE + 1));
+  publisher.stop();
+}
+
+TEST_CASE(publisherThreadRunsPostedTasksInOrderOnItsThread) {
+  SampleRing ring{16, OverflowPolicy::DropOldest};
+  std::vector<int32_t> order;
+  std::thread::id publisherId;
+  std::atomic<uint32_t> drained{0};
+  PublisherThread publisher{ring, [](SampleRecord const &) {},
+                            [&drained, &publisherId, &order]() {
+                              // Tasks have run before a drain ends.
+                              if (!order.empty()) {
+                                publisherId = std::this_thread::get_id();
+                              }
+                              drained++;
+                            }};
+  REQUIRE(publisher.isRunning());
+  uint32_t const BEFORE{drained.load()};
+  for (int32_t i{1}; i <= 3; i++) {
+    publisher.post([&order, i]() { order.push_back(i); });
+  }
+  CHECK(waitFor(drained, BEFORE + 1));
+  publisher.stop();
+  REQUIRE(3 == order.size());
+  CHECK(1 == order[0]);
+  CHECK(2 == order[1]);
+  CHECK(3 == order[2]);
+  CHECK(std::this_thread::get_id() != publisherId);
+  CHECK(std::thread::id() != publisherId);
+}
+
+TEST_CASE(publisherThreadRunsTasksPostedBeforeStop) {
+  SampleRing ring{16, OverflowPolicy::DropOldest};
+  std::atomic<uint32_t> ran{0};
+  {
+    PublisherThread publisher{ring, [](SampleRecord const &) {}, []() {}};
+    REQUIRE(publisher.isRunning());
+    publisher.post([&ran]() { ran++; });
+    publisher.stop();
+    CHECK(1 == ran.load());
+    // A task posted after stop() is released without being run.
+    publisher.post([&ran]() { ran++; });
+  }
+  CHECK(1 == ran.load());
+}
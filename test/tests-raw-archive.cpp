@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "raw-archive.hpp"
+#include "test-runner.hpp"
+
+namespace {
+AdcChannelConfig makeConfig() {
+  AdcChannelConfig config;
+  config.channel = 6;
+  config.senderStamp = 42;
+  config.conversion2Volt = 19.8f;
+  config.offset = -0.1f;
+  return config;
+}
+}  // namespace
+
+TEST_CASE(rawArchiveRoundTripsZigZagVarints) {
+  // Small and large deltas in both directions, including the extremes that
+  // need five varint bytes.
+  std::vector<int32_t> const RAW{0,    1,    -1,     4095, 0,
+                                 63,   64,   -64,    -65,  8191,
+                                 -8192, 2147483647, -2147483647 - 1, 3000,
+                                 3001};
+  ArchiveBlockEncoder encoder{makeConfig(), 1024, 1000000};
+  for (size_t i{0}; i < RAW.size(); i++) {
+    REQUIRE(encoder.add(RAW[i], 5000000 + static_cast<int64_t>(i) * 1000));
+  }
+  char const *data{encoder.data()};
+  ArchiveBlockHeader header;
+  REQUIRE(parseArchiveBlockHeader(data, encoder.size(), header));
+  CHECK(6 == header.channel);
+  CHECK(RAW.size() == header.sampleCount);
+  CHECK(encoder.size() - ARCHIVE_HEADER_SIZE == header.payloadSize);
+  CHECK(5000000 == header.baseTimeStamp);
+  CHECK(1000000 == header.samplePeriod);
+  CHECK(42 == header.senderStamp);
+  CHECK(test::isClose(header.conversion2Volt, 19.8));
+  CHECK(test::isClose(header.offset, -0.1));
+  std::vector<int32_t> raw(RAW.size());
+  REQUIRE(decodeArchivePayload(data + ARCHIVE_HEADER_SIZE, header.payloadSize,
+                               header.sampleCount, raw.data()));
+  CHECK(RAW == raw);
+}
+
+TEST_CASE(rawArchiveUsesOneByteForSmallDeltas) {
+  ArchiveBlockEncoder encoder{makeConfig(), 1024, 1000000};
+  REQUIRE(encoder.add(60, 0));
+  for (int32_t i{1}; i < 100; i++) {
+    REQUIRE(encoder.add(60 + (i % 2), i * 1000));
+  }
+  CHECK(ARCHIVE_HEADER_SIZE + 100 == encoder.size());
+}
+
+TEST_CASE(rawArchiveRejectsSamplesOffTheGrid) {
+  ArchiveBlockEncoder encoder{makeConfig(), 1024, 1000000};
+  REQUIRE(encoder.add(1, 1000));
+  CHECK(encoder.add(2, 2400));
+  CHECK(!encoder.add(3, 5000));
+  CHECK(encoder.add(3, 3000));
+}
+
+TEST_CASE(rawArchiveFillsBlocks) {
+  ArchiveBlockEncoder encoder{makeConfig(), 3, 1000000};
+  CHECK(encoder.isEmpty());
+  for (int32_t i{0}; i < 3; i++) {
+    CHECK(encoder.add(i, i * 1000));
+  }
+  CHECK(encoder.isFull());
+  CHECK(!encoder.add(3, 3000));
+  encoder.clear();
+  CHECK(encoder.isEmpty());
+  CHECK(ARCHIVE_HEADER_SIZE == encoder.size());
+}
+
+TEST_CASE(rawArchiveDecodesAStreamOfBlocks) {
+  std::string archive;
+  ArchiveBlockEncoder encoder{makeConfig(), 1024, 1000000};
+  for (int32_t block{0}; block < 2; block++) {
+    encoder.clear();
+    for (int32_t i{0}; i < 1024; i++) {
+      REQUIRE(encoder.add(3000 + (i * 7) % 32 + block,
+                          (block * 1024 + i) * 1000));
+    }
+    archive.append(encoder.data(), encoder.size());
+  }
+  std::istringstream in(archive);
+  ArchiveDecoder decoder{in};
+  for (int32_t block{0}; block < 2; block++) {
+    REQUIRE(decoder.next());
+    CHECK(1024 == decoder.header().sampleCount);
+    CHECK(block * 1024000 == decoder.header().baseTimeStamp);
+    REQUIRE(1024 == decoder.raw().size());
+    CHECK(3000 + (1023 * 7) % 32 + block == decoder.raw().back());
+  }
+  CHECK(!decoder.next());
+  CHECK(!decoder.isCorrupt());
+}
+
+TEST_CASE(rawArchiveDetectsCorruption) {
+  ArchiveBlockEncoder encoder{makeConfig(), 1024, 1000000};
+  for (int32_t i{0}; i < 10; i++) {
+    REQUIRE(encoder.add(i * 1000, i * 1000));
+  }
+  std::string const BLOCK(encoder.data(), encoder.size());
+
+  std::string badMagic{BLOCK};
+  badMagic[0] = 'X';
+  ArchiveBlockHeader header;
+  CHECK(!parseArchiveBlockHeader(badMagic.data(), badMagic.size(), header));
+
+  std::istringstream truncated(BLOCK.substr(0, BLOCK.size() - 1));
+  ArchiveDecoder truncatedDecoder{truncated};
+  CHECK(!truncatedDecoder.next());
+  CHECK(truncatedDecoder.isCorrupt());
+
+  std::istringstream truncatedHeader(BLOCK + BLOCK.substr(0, 10));
+  ArchiveDecoder headerDecoder{truncatedHeader};
+  CHECK(headerDecoder.next());
+  CHECK(!headerDecoder.next());
+  CHECK(headerDecoder.isCorrupt());
+
+  // A varint that never ends.
+  char const UNTERMINATED[]{'\x80', '\x80', '\x80', '\x80', '\x80', '\x01'};
+  int32_t raw{0};
+  CHECK(!decodeArchivePayload(UNTERMINATED, sizeof(UNTERMINATED), 1, &raw));
+}
+
+TEST_CASE(rawArchiveKeepsPeriodsBeyond32Bits) {
+  // 8 s between samples, as at 0.125 Hz, overflows 32-bit nanoseconds.
+  ArchiveBlockEncoder encoder{makeConfig(), 16, 8000000000};
+  REQUIRE(encoder.add(1, 0));
+  REQUIRE(encoder.add(2, 8000000));
+  std::string const BLOCK(encoder.data(), encoder.size());
+  std::istringstream in(BLOCK);
+  ArchiveDecoder decoder{in};
+  REQUIRE(decoder.next());
+  CHECK(8000000000 == decoder.header().samplePeriod);
+  CHECK(42 == decoder.header().senderStamp);
+  CHECK(2 == decoder.raw().size());
+}
+
+TEST_CASE(rawArchiveReadsVersion1Blocks) {
+  ArchiveBlockEncoder encoder{makeConfig(), 16, 1000000};
+  for (int32_t i{0}; i < 5; i++) {
+    REQUIRE(encoder.add(100 + i, i * 1000));
+  }
+  // The same block as version 1, with a 4-byte sample period.
+  std::string const BLOCK(encoder.data(), encoder.size());
+  std::string v1{BLOCK.substr(0, 24)};
+  v1[4] = '\x01';
+  v1 += BLOCK.substr(28);
+  REQUIRE(BLOCK.size() - 4 == v1.size());
+  std::string const ARCHIVE{v1 + BLOCK};
+  std::istringstream in(ARCHIVE);
+  ArchiveDecoder decoder{in};
+  for (int32_t block{0}; block < 2; block++) {
+    REQUIRE(decoder.next());
+    CHECK(1000000 == decoder.header().samplePeriod);
+    CHECK(42 == decoder.header().senderStamp);
+    CHECK(test::isClose(decoder.header().conversion2Volt, 19.8));
+    CHECK(test::isClose(decoder.header().offset, -0.1));
+    REQUIRE(5 == decoder.raw().size());
+    CHECK(104 == decoder.raw().back());
+  }
+  CHECK(!decoder.next());
+  CHECK(!decoder.isCorrupt());
+}
+
+TEST_CASE(rawArchiveInterleavesAlarmRecords) {
+  ArchiveAlarm alarm;
+  alarm.channel = 6;
+  alarm.isActive = true;
+  alarm.timeStamp = 1600000000123456;
+  alarm.since = 1600000000023456;
+  alarm.senderStamp = 42;
+  alarm.voltage = 9.5f;
+  alarm.threshold = 10.0f;
+  alarm.release = 10.5f;
+  char record[ARCHIVE_ALARM_SIZE];
+  encodeArchiveAlarm(alarm, record);
+
+  ArchiveBlockEncoder encoder{makeConfig(), 16, 1000000};
+  REQUIRE(encoder.add(2000, 0));
+  REQUIRE(encoder.add(2001, 1000));
+  std::string archive(record, sizeof(record));
+  archive.append(encoder.data(), encoder.size());
+  archive.append(record, sizeof(record));
+
+  std::istringstream in(archive);
+  ArchiveDecoder decoder{in};
+  REQUIRE(decoder.next());
+  REQUIRE(decoder.isAlarm());
+  CHECK(decoder.raw().empty());
+  CHECK(6 == decoder.alarm().channel);
+  CHECK(decoder.alarm().isActive);
+  CHECK(1600000000123456 == decoder.alarm().timeStamp);
+  CHECK(1600000000023456 == decoder.alarm().since);
+  CHECK(42 == decoder.alarm().senderStamp);
+  CHECK(test::isClose(9.5, decoder.alarm().voltage));
+  CHECK(test::isClose(10.0, decoder.alarm().threshold));
+  CHECK(test::isClose(10.5, decoder.alarm().release));
+  REQUIRE(decoder.next());
+  CHECK(!decoder.isAlarm());
+  REQUIRE(2 == decoder.raw().size());
+  CHECK(2001 == decoder.raw().back());
+  REQUIRE(decoder.next());
+  CHECK(decoder.isAlarm());
+  CHECK(!decoder.next());
+  CHECK(!decoder.isCorrupt());
+
+  // A cut-off alarm record is a truncated archive.
+  std::istringstream truncated(std::string(record, sizeof(record) - 1));
+  ArchiveDecoder truncatedDecoder{truncated};
+  CHECK(!truncatedDecoder.next());
+  CHECK(truncatedDecoder.isCorrupt());
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "recorder.hpp"
+#include "test-runner.hpp"
+
+namespace {
+std::string readFile(std::string const &path) {
+  std::ifstream in(path, std::ios::binary);
+  std::stringstream content;
+  content << in.rdbuf();
+  return content.str();
+}
+
+bool exists(std::string const &path) {
+  struct stat status {};
+  return 0 == ::stat(path.c_str(), &status);
+}
+}  // namespace
+
+TEST_CASE(recorderParsesFsyncPolicies) {
+  FsyncPolicy policy{FsyncPolicy::None};
+  CHECK(parseFsyncPolicy("rotate", policy));
+  CHECK(FsyncPolicy::Rotate == policy);
+  CHECK(parseFsyncPolicy("write", policy));
+  CHECK(FsyncPolicy::Write == policy);
+  CHECK(parseFsyncPolicy("none", policy));
+  CHECK(FsyncPolicy::None == policy);
+  CHECK(!parseFsyncPolicy("always", policy));
+}
+
+TEST_CASE(recorderAppendsToOneFileWithoutLimits) {
+  std::string const DIR{test::temporaryDirectory()};
+  REQUIRE(!DIR.empty());
+  std::string const PATH{DIR + "/voltages.rec"};
+  std::string expected;
+  {
+    Recorder recorder{PATH, 4096, 0, 0, FsyncPolicy::None, 1000000};
+    REQUIRE(recorder.isOpen());
+    for (int32_t i{0}; i < 100; i++) {
+      std::string const RECORD{"record " + std::to_string(i) + ";"};
+      CHECK(recorder.record(RECORD.data(), RECORD.size()));
+      expected += RECORD;
+    }
+    recorder.stop();
+    CHECK(expected.size() == recorder.recorded());
+    CHECK(0 == recorder.dropped());
+    CHECK(1 == recorder.files());
+  }
+  CHECK(expected == readFile(PATH));
+  ::unlink(PATH.c_str());
+  ::rmdir(DIR.c_str());
+}
+
+TEST_CASE(recorderRotatesBySizeBetweenRecords) {
+  std::string const DIR{test::temporaryDirectory()};
+  REQUIRE(!DIR.empty());
+  // Records of 10 bytes and files of at most 25 bytes: two records each.
+  std::string expected;
+  {
+    Recorder recorder{DIR + "/voltages.rec", 4096, 25, 0, FsyncPolicy::Rotate,
+                      1000000};
+    REQUIRE(recorder.isOpen());
+    for (int32_t i{0}; i < 7; i++) {
+      std::string const RECORD{"record-00" + std::to_string(i)};
+      REQUIRE(10 == RECORD.size());
+      CHECK(recorder.record(RECORD.data(), RECORD.size()));
+      expected += RECORD;
+    }
+    recorder.stop();
+    CHECK(70 == recorder.recorded());
+    CHECK(4 == recorder.files());
+  }
+  std::string joined;
+  for (int32_t file{0}; file < 4; file++) {
+    std::string const PATH{DIR + "/voltages-" + std::to_string(file) +
+                           ".rec"};
+    std::string const CONTENT{readFile(PATH)};
+    CHECK(CONTENT.size() == ((file < 3) ? 20u : 10u));
+    joined += CONTENT;
+    ::unlink(PATH.c_str());
+  }
+  CHECK(!exists(DIR + "/voltages-4.rec"));
+  CHECK(expected == joined);
+  ::rmdir(DIR.c_str());
+}
+
+TEST_CASE(recorderContinuesAfterExistingFiles) {
+  std::string const DIR{test::temporaryDirectory()};
+  REQUIRE(!DIR.empty());
+  std::ofstream(DIR + "/voltages-0.rec") << "old";
+  {
+    Recorder recorder{DIR + "/voltages.rec", 4096, 100, 0, FsyncPolicy::None,
+                      1000000};
+    REQUIRE(recorder.isOpen());
+    CHECK(recorder.record("new", 3));
+  }
+  CHECK("old" == readFile(DIR + "/voltages-0.rec"));
+  CHECK("new" == readFile(DIR + "/voltages-1.rec"));
+  ::unlink((DIR + "/voltages-0.rec").c_str());
+  ::unlink((DIR + "/voltages-1.rec").c_str());
+  ::rmdir(DIR.c_str());
+}
+
+TEST_CASE(recorderDropsWhatDoesNotFitTheRing) {
+  std::string const DIR{test::temporaryDirectory()};
+  REQUIRE(!DIR.empty());
+  std::string const PATH{DIR + "/voltages.rec"};
+  {
+    // A long write interval keeps the writer from draining the ring.
+    Recorder recorder{PATH, 64, 0, 0, FsyncPolicy::None, 200000000};
+    REQUIRE(recorder.isOpen());
+    std::string const RECORD(28, 'x');
+    CHECK(recorder.record(RECORD.data(), RECORD.size()));
+    CHECK(recorder.record(RECORD.data(), RECORD.size()));
+    CHECK(!recorder.record(RECORD.data(), RECORD.size()));
+    CHECK(1 == recorder.dropped());
+  }
+  CHECK(56 == readFile(PATH).size());
+  ::unlink(PATH.c_str());
+  ::rmdir(DIR.c_str());
+}
+
+TEST_CASE(recorderTakesRecordsFromTwoProducers) {
+  std::string const DIR{test::temporaryDirectory()};
+  REQUIRE(!DIR.empty());
+  std::string const PATH{DIR + "/voltages.rec"};
+  uint32_t const RECORDS{10000};
+  {
+    Recorder recorder{PATH, 1024 * 1024, 0, 0, FsyncPolicy::None, 1000000, 2};
+    REQUIRE(recorder.isOpen());
+    auto produce{[&recorder](char c, size_t producer) {
+      std::string const RECORD(7, c);
+      for (uint32_t i{0}; i < RECORDS; i++) {
+        recorder.record(RECORD.data(), RECORD.size(), producer);
+      }
+    }};
+    std::thread other{produce, 'a', 1};
+    produce('b', 0);
+    other.join();
+    CHECK(0 == recorder.dropped());
+  }
+  // Records from both threads are whole and none is lost.
+  std::string const CONTENT{readFile(PATH)};
+  REQUIRE(2 * RECORDS * 7 == CONTENT.size());
+  uint32_t as{0};
+  for (size_t i{0}; i < CONTENT.size(); i += 7) {
+    std::string const RECORD{CONTENT.substr(i, 7)};
+    CHECK(std::string(7, RECORD[0]) == RECORD);
+    as += ('a' == RECORD[0]) ? 1 : 0;
+  }
+  CHECK(RECORDS == as);
+  ::unlink(PATH.c_str());
+  ::rmdir(DIR.c_str());
+}
+
+TEST_CASE(recorderKeepsARingPerProducer) {
+  std::string const DIR{test::temporaryDirectory()};
+  REQUIRE(!DIR.empty());
+  std::string const PATH{DIR + "/voltages.rec"};
+  {
+    // A long write interval keeps the writer from draining the rings.
+    Recorder recorder{PATH, 64, 0, 0, FsyncPolicy::None, 200000000, 2};
+    REQUIRE(recorder.isOpen());
+    std::string const RECORD(28, 'x');
+    CHECK(recorder.record(RECORD.data(), RECORD.size(), 0));
+    CHECK(recorder.record(RECORD.data(), RECORD.size(), 0));
+    CHECK(!recorder.record(RECORD.data(), RECORD.size(), 0));
+    std::string const ALARM(28, 'a');
+    CHECK(recorder.record(ALARM.data(), ALARM.size(), 1));
+    CHECK(1 == recorder.dropped());
+  }
+  CHECK(std::string(56, 'x') + std::string(28, 'a') == readFile(PATH));
+  ::unlink(PATH.c_str());
+  ::rmdir(DIR.c_str());
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sample-ring.hpp"
+#include "test-runner.hpp"
+
+namespace {
+SampleRecord makeRecord(int64_t sampleTime) {
+  SampleRecord record;
+  record.sampleTime = sampleTime;
+  record.voltage = static_cast<float>(sampleTime) * 0.5f;
+  record.index = static_cast<uint32_t>(sampleTime % 7);
+  return record;
+}
+}  // namespace
+
+TEST_CASE(sampleRingParsesOverflowPolicies) {
+  OverflowPolicy policy{OverflowPolicy::DropNewest};
+  CHECK(parseOverflowPolicy("drop-oldest", policy));
+  CHECK(OverflowPolicy::DropOldest == policy);
+  CHECK(parseOverflowPolicy("drop-newest", policy));
+  CHECK(OverflowPolicy::DropNewest == policy);
+  CHECK(!parseOverflowPolicy("drop-all", policy));
+}
+
+TEST_CASE(sampleRingKeepsOrderAndFields) {
+  SampleRing ring{8, OverflowPolicy::DropOldest};
+  for (int64_t i{1}; i <= 5; i++) {
+    CHECK(ring.push(makeRecord(i)));
+  }
+  CHECK(5 == ring.size());
+  SampleRecord record;
+  for (int64_t i{1}; i <= 5; i++) {
+    REQUIRE(ring.pop(record));
+    CHECK(i == record.sampleTime);
+    CHECK(test::isClose(record.voltage, static_cast<double>(i) * 0.5));
+    CHECK(static_cast<uint32_t>(i % 7) == record.index);
+  }
+  CHECK(!ring.pop(record));
+  CHECK(0 == ring.size());
+  CHECK(5 == ring.maxSize());
+}
+
+TEST_CASE(sampleRingDropOldestKeepsNewest) {
+  SampleRing ring{4, OverflowPolicy::DropOldest};
+  for (int64_t i{1}; i <= 10; i++) {
+    CHECK(ring.push(makeRecord(i)));
+  }
+  CHECK(4 == ring.size());
+  CHECK(10 == ring.pushed());
+  CHECK(6 == ring.dropped());
+  SampleRecord record;
+  for (int64_t i{7}; i <= 10; i++) {
+    REQUIRE(ring.pop(record));
+    CHECK(i == record.sampleTime);
+  }
+  CHECK(!ring.pop(record));
+}
+
+TEST_CASE(sampleRingDropNewestKeepsOldest) {
+  SampleRing ring{4, OverflowPolicy::DropNewest};
+  for (int64_t i{1}; i <= 10; i++) {
+    CHECK(ring.push(makeRecord(i)) == (i <= 4));
+  }
+  CHECK(4 == ring.pushed());
+  CHECK(6 == ring.dropped());
+  SampleRecord record;
+  for (int64_t i{1}; i <= 4; i++) {
+    REQUIRE(ring.pop(record));
+    CHECK(i == record.sampleTime);
+  }
+  CHECK(!ring.pop(record));
+}
+
+TEST_CASE(sampleRingWrapsAround) {
+  SampleRing ring{3, OverflowPolicy::DropOldest};
+  SampleRecord record;
+  for (int64_t i{1}; i <= 100; i++) {
+    CHECK(ring.push(makeRecord(i)));
+    REQUIRE(ring.pop(record));
+    CHECK(i == record.sampleTime);
+  }
+  CHECK(0 == ring.dropped());
+  CHECK(1 == ring.maxSize());
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <limits>
+
+#include "sampling-leases.hpp"
+#include "test-runner.hpp"
+
+namespace {
+SamplingLease makeLease(uint32_t holder, uint8_t channel, float frequency,
+                        int64_t expiresAt) {
+  SamplingLease lease;
+  lease.holder = holder;
+  lease.channel = channel;
+  lease.frequency = frequency;
+  lease.expiresAt = expiresAt;
+  return lease;
+}
+}  // namespace
+
+TEST_CASE(samplingLeasesRaiseTheRateUntilExpiry) {
+  SamplingLeases leases{4};
+  CHECK(test::isClose(leases.frequency(1.0f), 1.0));
+  CHECK(leases.grant(makeLease(1, 6, 200.0f, 1000), 0));
+  CHECK(leases.grant(makeLease(2, 6, 1000.0f, 500), 0));
+  CHECK(2 == leases.size());
+  CHECK(500 == leases.nextExpiry());
+  CHECK(test::isClose(leases.frequency(1.0f), 1000.0));
+  // An idle rate above all leases wins.
+  CHECK(test::isClose(leases.frequency(2000.0f), 2000.0));
+
+  CHECK(!leases.expire(499));
+  CHECK(leases.expire(500));
+  CHECK(1 == leases.size());
+  CHECK(1000 == leases.nextExpiry());
+  CHECK(test::isClose(leases.frequency(1.0f), 200.0));
+  CHECK(leases.expire(1000));
+  CHECK(0 == leases.size());
+  CHECK(test::isClose(leases.frequency(1.0f), 1.0));
+}
+
+TEST_CASE(samplingLeasesRenewPerHolderAndChannel) {
+  SamplingLeases leases{4};
+  CHECK(leases.grant(makeLease(1, 6, 200.0f, 1000), 0));
+  CHECK(leases.grant(makeLease(1, 6, 100.0f, 3000), 0));
+  CHECK(leases.grant(makeLease(1, 5, 100.0f, 2000), 0));
+  CHECK(2 == leases.size());
+  CHECK(2000 == leases.nextExpiry());
+  CHECK(test::isClose(leases.frequency(1.0f), 100.0));
+}
+
+TEST_CASE(samplingLeasesAreReturnedEarly) {
+  SamplingLeases leases{4};
+  CHECK(leases.grant(makeLease(1, 6, 200.0f, 1000), 0));
+  // A zero rate or a lease that already expired returns it.
+  CHECK(leases.grant(makeLease(1, 6, 0.0f, 1000), 10));
+  CHECK(0 == leases.size());
+  CHECK(leases.grant(makeLease(2, 6, 200.0f, 1000), 0));
+  CHECK(leases.grant(makeLease(2, 6, 200.0f, 5), 10));
+  CHECK(0 == leases.size());
+  // Returning a lease that is not held changes nothing.
+  CHECK(leases.grant(makeLease(3, 6, 0.0f, 1000), 10));
+  CHECK(0 == leases.size());
+}
+
+TEST_CASE(samplingLeasesAreBounded) {
+  SamplingLeases leases{2};
+  CHECK(leases.grant(makeLease(1, 6, 200.0f, 1000), 0));
+  CHECK(leases.grant(makeLease(2, 6, 200.0f, 1000), 0));
+  CHECK(!leases.grant(makeLease(3, 6, 200.0f, 1000), 0));
+  // Renewals still fit.
+  CHECK(leases.grant(makeLease(2, 6, 300.0f, 2000), 0));
+  CHECK(2 == leases.size());
+}
+
+TEST_CASE(samplingLeasesAreBuiltFromValidRequests) {
+  SamplingLease lease;
+  REQUIRE(makeSamplingLease(7, 6, 500.0f, 2.5f, 1000.0f, 1000, lease));
+  CHECK(7 == lease.holder);
+  CHECK(6 == lease.channel);
+  CHECK(test::isClose(lease.frequency, 500.0));
+  CHECK(1000 + 2500000000 == lease.expiresAt);
+  REQUIRE(makeSamplingLease(7, 6, 1000.0f, MAX_LEASE_DURATION, 1000.0f, 0,
+                            lease));
+  CHECK(3600000000000 == lease.expiresAt);
+
+  // A rate of 0 returns the lease, whatever the duration.
+  REQUIRE(makeSamplingLease(7, 6, 0.0f, 0.0f, 1000.0f, 1000, lease));
+  SamplingLeases leases{4};
+  CHECK(leases.grant(makeLease(7, 6, 500.0f, 5000), 0));
+  CHECK(leases.grant(lease, 1000));
+  CHECK(0 == leases.size());
+}
+
+TEST_CASE(samplingLeasesRejectInvalidRequests) {
+  float const NAN_VALUE{std::numeric_limits<float>::quiet_NaN()};
+  float const INFINITE{std::numeric_limits<float>::infinity()};
+  float const INVALID_FREQUENCIES[]{NAN_VALUE, INFINITE, -INFINITE, -1.0f,
+                                    1000.5f};
+  float const INVALID_DURATIONS[]{NAN_VALUE, INFINITE, -INFINITE, -1.0f, 0.0f,
+                                  MAX_LEASE_DURATION * 2.0f, 1.0e30f};
+  SamplingLease lease;
+  lease.expiresAt = 42;
+  for (float frequency : INVALID_FREQUENCIES) {
+    CHECK(!makeSamplingLease(7, 6, frequency, 1.0f, 1000.0f, 0, lease));
+  }
+  for (float duration : INVALID_DURATIONS) {
+    CHECK(!makeSamplingLease(7, 6, 100.0f, duration, 1000.0f, 0, lease));
+  }
+  // Rejected requests leave the lease untouched.
+  CHECK(42 == lease.expiresAt);
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "cluon-complete.hpp"
+#include "shared-voltage-reader.hpp"
+#include "shared-voltage-ring.hpp"
+#include "test-runner.hpp"
+
+namespace {
+std::vector<AdcChannelConfig> makeConfigs() {
+  std::vector<AdcChannelConfig> configs(2);
+  configs[0].channel = 5;
+  configs[0].senderStamp = 10;
+  configs[1].channel = 6;
+  configs[1].senderStamp = 11;
+  return configs;
+}
+}  // namespace
+
+TEST_CASE(sharedVoltageRingRoundTripsThroughAReader) {
+  std::string const NAME{"/adc-bbblue-test-" + std::to_string(::getpid())};
+  SharedVoltageRing ring{NAME, makeConfigs(), 8};
+  REQUIRE(ring.isValid());
+  cluon::SharedMemory attached{NAME};
+  shared_voltage::Reader reader{attached.data(), attached.size()};
+  REQUIRE(reader.isValid());
+  CHECK(2 == reader.channelCount());
+  CHECK(8 == reader.capacity());
+  CHECK(6 == reader.channel(1));
+  CHECK(11 == reader.senderStamp(1));
+
+  shared_voltage::Sample sample;
+  CHECK(!reader.latest(1, sample));
+  for (int64_t i{0}; i < 20; i++) {
+    ring.write(1, 12.0f + static_cast<float>(i) * 0.25f, 1000 * i);
+  }
+  ring.write(0, 5.0f, 7);
+  CHECK(20 == reader.head(1));
+  REQUIRE(reader.latest(1, sample));
+  CHECK(19 == sample.number);
+  CHECK(19000 == sample.sampleTime);
+  CHECK(test::isClose(sample.voltage, 16.75));
+  // The ring keeps the newest eight samples.
+  CHECK(reader.read(1, 12, sample));
+  CHECK(12000 == sample.sampleTime);
+  CHECK(!reader.read(1, 11, sample));
+  CHECK(!reader.read(1, 20, sample));
+  REQUIRE(reader.latest(0, sample));
+  CHECK(7 == sample.sampleTime);
+  CHECK(test::isClose(sample.voltage, 5.0));
+}
+
+TEST_CASE(sharedVoltageReaderRejectsForeignAreas) {
+  std::vector<char> area(4096, 0);
+  shared_voltage::Reader reader{area.data(), area.size()};
+  CHECK(!reader.isValid());
+  shared_voltage::Reader empty{nullptr, 0};
+  CHECK(!empty.isValid());
+}
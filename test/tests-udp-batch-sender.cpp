@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cluon-complete.hpp"
+#include "od4-sender.hpp"
+#include "opendlv-standard-message-set.hpp"
+#include "test-runner.hpp"
+#include "udp-batch-sender.hpp"
+
+namespace {
+// UDP socket on an ephemeral loopback port that the senders under test
+// send to.
+class LoopbackReceiver {
+ private:
+  LoopbackReceiver(LoopbackReceiver const &) = delete;
+  LoopbackReceiver(LoopbackReceiver &&) = delete;
+  LoopbackReceiver &operator=(LoopbackReceiver const &) = delete;
+  LoopbackReceiver &operator=(LoopbackReceiver &&) = delete;
+
+ public:
+  LoopbackReceiver() noexcept
+      : m_socket{::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_UDP)},
+        m_port{0} {
+    struct sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length{sizeof(address)};
+    if (m_socket >= 0 &&
+        0 == ::bind(m_socket, reinterpret_cast<struct sockaddr *>(&address),
+                    sizeof(address)) &&
+        0 == ::getsockname(m_socket,
+                           reinterpret_cast<struct sockaddr *>(&address),
+                           &length)) {
+      m_port = ntohs(address.sin_port);
+    }
+  }
+  ~LoopbackReceiver() noexcept {
+    if (m_socket >= 0) {
+      ::close(m_socket);
+    }
+  }
+
+ public:
+  uint16_t port() const noexcept {
+    return m_port;
+  }
+
+  // The next datagram, or an empty string when none arrives in time.
+  std::string receive(int32_t timeoutInMilliseconds = 1000) noexcept {
+    struct pollfd event {};
+    event.fd = m_socket;
+    event.events = POLLIN;
+    if (1 != ::poll(&event, 1, timeoutInMilliseconds)) {
+      return std::string();
+    }
+    std::vector<char> buffer(65536);
+    ssize_t const RECEIVED{::recv(m_socket, buffer.data(), buffer.size(), 0)};
+    return (RECEIVED > 0)
+               ? std::string(buffer.data(), static_cast<size_t>(RECEIVED))
+               : std::string();
+  }
+
+ private:
+  int32_t m_socket;
+  uint16_t m_port;
+};
+
+std::string serializedReading(float voltage) {
+  opendlv::proxy::VoltageReading reading;
+  reading.voltage(voltage);
+  cluon::data::TimeStamp sampleTime;
+  sampleTime.seconds(1600000000).microseconds(123);
+  return Od4Sender::serialize(reading, sampleTime, 1);
+}
+}  // namespace
+
+TEST_CASE(udpBatchSenderFlushesOnceAtTheCountBound) {
+  LoopbackReceiver receiver;
+  REQUIRE(0 != receiver.port());
+  UdpBatchSender sender{"127.0.0.1", receiver.port(), 3,
+                        UdpBatchSender::MAX_DELAY};
+  REQUIRE(sender.isOpen());
+  std::string const DATA[]{serializedReading(1.0f), serializedReading(2.0f),
+                           serializedReading(3.0f)};
+  sender.send(DATA[0].data(), DATA[0].size(), 0);
+  sender.send(DATA[1].data(), DATA[1].size(), 0);
+  CHECK(2 == sender.queued());
+  CHECK(0 == sender.syscalls());
+  CHECK(receiver.receive(50).empty());
+
+  sender.send(DATA[2].data(), DATA[2].size(), 0);
+  CHECK(0 == sender.queued());
+  CHECK(1 == sender.syscalls());
+  CHECK(3 == sender.datagrams());
+  for (std::string const &data : DATA) {
+    CHECK(data == receiver.receive());
+  }
+}
+
+TEST_CASE(udpBatchSenderFlushesOnceTheOldestReadingIsOldEnough) {
+  LoopbackReceiver receiver;
+  REQUIRE(0 != receiver.port());
+  UdpBatchSender sender{"127.0.0.1", receiver.port(),
+                        UdpBatchSender::MAX_QUEUE, 1000000};
+  REQUIRE(sender.isOpen());
+  std::string const DATA{serializedReading(1.0f)};
+  sender.send(DATA.data(), DATA.size(), 5000000);
+  sender.send(DATA.data(), DATA.size(), 5900000);
+  sender.onTickEnd(5999999);
+  CHECK(2 == sender.queued());
+  CHECK(receiver.receive(50).empty());
+
+  sender.onTickEnd(6000000);
+  CHECK(0 == sender.queued());
+  CHECK(1 == sender.syscalls());
+  CHECK(DATA == receiver.receive());
+  CHECK(DATA == receiver.receive());
+}
+
+TEST_CASE(udpBatchSenderSendsTheSameBytesAsTheLibcluonSender) {
+  LoopbackReceiver receiver;
+  REQUIRE(0 != receiver.port());
+  UdpBatchSender sender{"127.0.0.1", receiver.port(), 1, 0};
+  REQUIRE(sender.isOpen());
+  cluon::UDPSender reference{"127.0.0.1", receiver.port()};
+
+  // A reading goes through a slot, a long status message around the queue.
+  opendlv::system::SignalStatusMessage status;
+  status.code(5).description(std::string(2 * UdpBatchSender::SLOT_SIZE, 'x'));
+  std::string const DATA[]{
+      serializedReading(4.5f),
+      Od4Sender::serialize(status, cluon::data::TimeStamp{}, 2)};
+  CHECK(DATA[0].size() <= UdpBatchSender::SLOT_SIZE);
+  CHECK(DATA[1].size() > UdpBatchSender::SLOT_SIZE);
+  for (std::string const &data : DATA) {
+    sender.send(data.data(), data.size(), 0);
+    std::string const SENT{receiver.receive()};
+    reference.send(std::string(data));
+    std::string const REFERENCE{receiver.receive()};
+    CHECK(!SENT.empty());
+    CHECK(REFERENCE == SENT);
+    CHECK(data == SENT);
+  }
+  CHECK(2 == sender.datagrams());
+  CHECK(0 == sender.errors());
+}
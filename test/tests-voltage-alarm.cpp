@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+
+#include "test-runner.hpp"
+#include "voltage-alarm.hpp"
+
+TEST_CASE(voltageAlarmParsesRules) {
+  std::vector<AlarmRule> const RULES{
+      parseAlarmRules("6:10.5,5:4.5:4.8:250")};
+  REQUIRE(2 == RULES.size());
+  CHECK(6 == RULES[0].channel);
+  CHECK(test::isClose(RULES[0].threshold, 10.5));
+  CHECK(test::isClose(RULES[0].release, 10.5));
+  CHECK(0 == RULES[0].minDuration);
+  CHECK(5 == RULES[1].channel);
+  CHECK(test::isClose(RULES[1].release, 4.8));
+  CHECK(250000 == RULES[1].minDuration);
+}
+
+TEST_CASE(voltageAlarmRejectsInvalidRules) {
+  char const *const INVALID[]{"6", "7:10", "6:10:9", "6:10:11:-5",
+                              "6:1:2:3:4"};
+  for (char const *rule : INVALID) {
+    bool isRejected{false};
+    try {
+      parseAlarmRules(rule);
+    } catch (std::invalid_argument const &) {
+      isRejected = true;
+    }
+    CHECK(isRejected);
+  }
+}
+
+TEST_CASE(voltageAlarmHysteresis) {
+  AlarmRule rule;
+  rule.threshold = 10.0f;
+  rule.release = 11.0f;
+  VoltageAlarm alarm{rule};
+  CHECK(VoltageAlarm::NONE == alarm.update(12.0f, 0));
+  CHECK(VoltageAlarm::RAISED == alarm.update(9.9f, 1000));
+  CHECK(alarm.isActive());
+  CHECK(1000 == alarm.since());
+  CHECK(VoltageAlarm::NONE == alarm.update(9.0f, 2000));
+  // Back above the threshold but not above the release voltage.
+  CHECK(VoltageAlarm::NONE == alarm.update(10.5f, 3000));
+  CHECK(VoltageAlarm::NONE == alarm.update(11.0f, 4000));
+  CHECK(alarm.isActive());
+  CHECK(VoltageAlarm::CLEARED == alarm.update(11.1f, 5000));
+  CHECK(!alarm.isActive());
+  CHECK(VoltageAlarm::NONE == alarm.update(10.5f, 6000));
+}
+
+TEST_CASE(voltageAlarmNeedsTheMinimumDuration) {
+  AlarmRule rule;
+  rule.threshold = 10.0f;
+  rule.release = 10.0f;
+  rule.minDuration = 5000;
+  VoltageAlarm alarm{rule};
+  CHECK(VoltageAlarm::NONE == alarm.update(9.0f, 0));
+  CHECK(VoltageAlarm::NONE == alarm.update(9.0f, 4999));
+  // A short recovery restarts the duration.
+  CHECK(VoltageAlarm::NONE == alarm.update(10.0f, 5000));
+  CHECK(VoltageAlarm::NONE == alarm.update(9.0f, 6000));
+  CHECK(VoltageAlarm::NONE == alarm.update(9.0f, 10999));
+  CHECK(VoltageAlarm::RAISED == alarm.update(9.0f, 11000));
+  CHECK(6000 == alarm.since());
+}
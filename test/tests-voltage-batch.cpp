@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "cluon-complete.hpp"
+#include "deadline-scheduler.hpp"
+#include "opendlv-device-adc-bbblue-message-set.hpp"
+#include "test-runner.hpp"
+#include "voltage-batch.hpp"
+
+TEST_CASE(voltageBatchPacksLittleEndianFloats) {
+  VoltageBatch batch{4, 0, 1000000};
+  CHECK(batch.isEmpty());
+  batch.add(12.5f, 1000);
+  batch.add(-1.0f, 2000);
+  CHECK(2 == batch.size());
+  CHECK(1000 == batch.baseTimeStamp());
+  CHECK(1000000 == batch.period());
+  std::string const &SAMPLES{batch.samples()};
+  REQUIRE(8 == SAMPLES.size());
+  // 12.5f is 0x41480000, -1.0f is 0xbf800000.
+  char const EXPECTED[]{'\x00', '\x00', '\x48', '\x41',
+                        '\x00', '\x00', '\x80', '\xbf'};
+  CHECK(0 == std::memcmp(EXPECTED, SAMPLES.data(), sizeof(EXPECTED)));
+}
+
+TEST_CASE(voltageBatchFitsOnlyEvenlySpacedSamples) {
+  VoltageBatch batch{100, 0, 1000000};
+  CHECK(batch.fits(12345));
+  batch.add(1.0f, 10000);
+  CHECK(batch.fits(11000));
+  CHECK(batch.fits(11499));
+  CHECK(!batch.fits(11501));
+  CHECK(!batch.fits(12000));
+}
+
+TEST_CASE(voltageBatchIsFullByCountOrAge) {
+  VoltageBatch byCount{3, 0, 1000000};
+  byCount.add(1.0f, 0);
+  byCount.add(1.0f, 1000);
+  CHECK(!byCount.isFull(1000000000));
+  byCount.add(1.0f, 2000);
+  CHECK(byCount.isFull(2000));
+
+  VoltageBatch byAge{100, 5000, 1000000};
+  CHECK(!byAge.isFull(1000000));
+  byAge.add(1.0f, 1000);
+  CHECK(!byAge.isFull(5999));
+  CHECK(byAge.isFull(6000));
+}
+
+TEST_CASE(voltageBatchCountsSequenceNumbers) {
+  VoltageBatch batch{VoltageBatch::MAX_SAMPLES + 1, 0, 1000000};
+  for (uint32_t i{0}; i < VoltageBatch::MAX_SAMPLES; i++) {
+    batch.add(1.0f, i * 1000);
+  }
+  CHECK(batch.isFull(0));
+  CHECK(0 == batch.clear());
+  CHECK(batch.isEmpty());
+  CHECK(1 == batch.clear());
+  // Reconfiguring keeps counting, so receivers see no gap.
+  batch.reconfigure(10, 0, 2000000);
+  CHECK(2000000 == batch.period());
+  CHECK(2 == batch.clear());
+}
+
+TEST_CASE(voltageBatchKeepsPeriodsBeyond32Bits) {
+  // At 0.125 Hz, the period of 8 s in nanoseconds does not fit 32 bits.
+  int64_t const PERIOD{DeadlineScheduler::periodFromFrequency(0.125f)};
+  CHECK(8000000000 == PERIOD);
+  VoltageBatch batch{10, 0, PERIOD};
+  CHECK(PERIOD == batch.period());
+  batch.add(1.0f, 0);
+  CHECK(batch.fits(8000000));
+  CHECK(!batch.fits(3705032));
+  opendlv::device::adc::VoltageReadingBatch message;
+  message.samplePeriod(static_cast<uint64_t>(batch.period()));
+  CHECK(8000000000 == message.samplePeriod());
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <string>
+
+#include "cluon-complete.hpp"
+#include "opendlv-standard-message-set.hpp"
+#include "test-runner.hpp"
+#include "voltage-envelope-encoder.hpp"
+
+namespace {
+// The encoding done by OD4Session::send followed by serializeEnvelope.
+std::string encodeWithCluon(float voltage, cluon::data::TimeStamp const &sent,
+                            cluon::data::TimeStamp const &sampleTime,
+                            uint32_t senderStamp) {
+  opendlv::proxy::VoltageReading voltageReading;
+  voltageReading.voltage(voltage);
+  cluon::ToProtoVisitor protoEncoder;
+  cluon::data::Envelope envelope;
+  envelope.dataType(static_cast<int32_t>(voltageReading.ID()));
+  voltageReading.accept(protoEncoder);
+  envelope.serializedData(protoEncoder.encodedData());
+  envelope.sent(sent);
+  envelope.sampleTimeStamp(
+      (0 == (sampleTime.seconds() + sampleTime.microseconds())) ? sent
+                                                                : sampleTime);
+  envelope.senderStamp(senderStamp);
+  return cluon::serializeEnvelope(std::move(envelope));
+}
+}  // namespace
+
+TEST_CASE(voltageEnvelopeEncoderMatchesCluon) {
+  VoltageEnvelopeEncoder encoder{opendlv::proxy::VoltageReading::ID()};
+  float const VOLTAGES[]{0.0f, -0.1f, 12.6f, 19.7f, -1.0e30f};
+  int32_t const SECONDS[]{0, 1, 63, 64, 1600000000, -1, 2147483647};
+  int32_t const MICROSECONDS[]{0, 1, 127, 999999};
+  uint32_t const SENDER_STAMPS[]{0, 127, 128, 16384, 4294967295u};
+  for (float voltage : VOLTAGES) {
+    for (int32_t seconds : SECONDS) {
+      for (int32_t microseconds : MICROSECONDS) {
+        for (uint32_t senderStamp : SENDER_STAMPS) {
+          cluon::data::TimeStamp sent;
+          sent.seconds(seconds).microseconds(microseconds);
+          cluon::data::TimeStamp sampleTime;
+          sampleTime.seconds(seconds / 2).microseconds(microseconds / 3);
+          std::string const EXPECTED{
+              encodeWithCluon(voltage, sent, sampleTime, senderStamp)};
+          char buffer[VoltageEnvelopeEncoder::MAX_SIZE];
+          size_t const SIZE{encoder.encode(
+              buffer, voltage, sent.seconds(), sent.microseconds(),
+              sampleTime.seconds(), sampleTime.microseconds(), senderStamp)};
+          REQUIRE(SIZE <= VoltageEnvelopeEncoder::MAX_SIZE);
+          CHECK(EXPECTED == std::string(buffer, SIZE));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE(voltageEnvelopeEncoderDecodesWithCluon) {
+  VoltageEnvelopeEncoder encoder{opendlv::proxy::VoltageReading::ID()};
+  char buffer[VoltageEnvelopeEncoder::MAX_SIZE];
+  size_t const SIZE{
+      encoder.encode(buffer, 12.6f, 1600000000, 250000, 1600000000, 1000, 6)};
+  std::stringstream in(std::string(buffer, SIZE));
+  auto result = cluon::extractEnvelope(in);
+  REQUIRE(result.first);
+  cluon::data::Envelope envelope{std::move(result.second)};
+  CHECK(opendlv::proxy::VoltageReading::ID() == envelope.dataType());
+  CHECK(6 == envelope.senderStamp());
+  CHECK(1600000000 == envelope.sent().seconds());
+  CHECK(250000 == envelope.sent().microseconds());
+  CHECK(1000 == envelope.sampleTimeStamp().microseconds());
+  auto const READING{
+      cluon::extractMessage<opendlv::proxy::VoltageReading>(
+          std::move(envelope))};
+  CHECK(test::isClose(READING.voltage(), 12.6, 1.0e-6));
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2020 Björnborg Nguyen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test-runner.hpp"
+#include "voltage-statistics.hpp"
+
+TEST_CASE(voltageStatisticsAlignsWindows) {
+  VoltageStatistics statistics{1000000};
+  CHECK(statistics.isInWindow(1234567));
+  statistics.add(12.0f, 1234567);
+  CHECK(1000000 == statistics.windowStart());
+  CHECK(statistics.isInWindow(1999999));
+  CHECK(!statistics.isInWindow(2000000));
+  CHECK(!statistics.isInWindow(999999));
+
+  // Negative time stamps round down as well.
+  VoltageStatistics negative{1000000};
+  negative.add(12.0f, -1);
+  CHECK(-1000000 == negative.windowStart());
+}
+
+TEST_CASE(voltageStatisticsSummarizesAWindow) {
+  VoltageStatistics statistics{1000000};
+  float const VOLTAGES[]{12.0f, 12.5f, 11.5f, 13.0f, 11.0f};
+  int64_t time{0};
+  for (float voltage : VOLTAGES) {
+    statistics.add(voltage, time);
+    time += 1000;
+  }
+  CHECK(5 == statistics.count());
+  CHECK(test::isClose(statistics.minimum(), 11.0));
+  CHECK(test::isClose(statistics.maximum(), 13.0));
+  CHECK(test::isClose(statistics.mean(), 12.0, 1.0e-5));
+  // Sample variance: (0 + 0.25 + 0.25 + 1 + 1) / 4.
+  CHECK(test::isClose(statistics.variance(), 0.625, 1.0e-5));
+}
+
+TEST_CASE(voltageStatisticsStartsOverWhenCleared) {
+  VoltageStatistics statistics{1000000};
+  statistics.add(1.0f, 0);
+  statistics.add(3.0f, 1000);
+  statistics.clear();
+  CHECK(0 == statistics.count());
+  CHECK(statistics.isInWindow(5500000));
+  statistics.add(7.0f, 5500000);
+  CHECK(5000000 == statistics.windowStart());
+  CHECK(test::isClose(statistics.minimum(), 7.0));
+  CHECK(test::isClose(statistics.mean(), 7.0));
+  CHECK(test::isClose(statistics.variance(), 0.0));
+}
+
+TEST_CASE(voltageStatisticsLimitsTheWindow) {
+  VoltageStatistics statistics{2 * VoltageStatistics::MAX_WINDOW};
+  CHECK(VoltageStatistics::MAX_WINDOW == statistics.window());
+  statistics.add(1.0f, VoltageStatistics::MAX_WINDOW + 1);
+  CHECK(VoltageStatistics::MAX_WINDOW == statistics.windowStart());
+}